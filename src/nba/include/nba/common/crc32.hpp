@@ -5,25 +5,46 @@
  * Refer to the included LICENSE file.
  */
 
+#pragma once
+
+#include <array>
+#include <cstddef>
 #include <nba/integer.hpp>
 
 namespace nba {
 
-inline u32 crc32(u8 const* data, int length) {
-  u32 crc32 = 0xFFFFFFFF;
+namespace detail {
 
-  while(length-- != 0) {
-    u8 byte = *data++;
+inline constexpr auto g_crc32_table = []() constexpr {
+  std::array<u32, 256> table{};
+
+  for(u32 i = 0; i < 256; i++) {
+    u32 crc32 = i;
 
-    // TODO: speed this up using a lookup table.
-    for(int i = 0; i < 8; i++) {
-      if((crc32 ^ byte) & 1) {
+    for(int j = 0; j < 8; j++) {
+      if(crc32 & 1) {
         crc32 = (crc32 >> 1) ^ 0xEDB88320;
       } else {
         crc32 >>= 1;
       }
-      byte >>= 1;
     }
+
+    table[i] = crc32;
+  }
+
+  return table;
+}();
+
+} // namespace detail
+
+/**
+ * Pass the result of a previous call as `crc32` to continue the checksum over the next block of data.
+ */
+inline u32 crc32(u8 const* data, size_t length, u32 crc32 = 0) {
+  crc32 = ~crc32;
+
+  while(length-- != 0) {
+    crc32 = (crc32 >> 8) ^ detail::g_crc32_table[(crc32 ^ *data++) & 0xFF];
   }
 
   return ~crc32;
@@ -23,13 +23,29 @@ struct Resampler : WriteStream<T> {
   Resampler(std::shared_ptr<WriteStream<T>> output) : output(output) {}
   
   virtual void SetSampleRates(float samplerate_in, float samplerate_out) {
-    resample_phase_shift = samplerate_in / samplerate_out;
+    this->samplerate_in = samplerate_in;
+    this->samplerate_out = samplerate_out;
+    resample_phase_shift = samplerate_in / (samplerate_out * rate_adjustment);
+  }
+
+  /**
+   * Scales the output sample rate by a factor close to one, for example to keep an audio buffer at a constant fill level.
+   * Unlike SetSampleRates() this does not redesign the filter, so it is cheap enough to be called for every audio block.
+   */
+  void SetRateAdjustment(float factor) {
+    rate_adjustment = factor;
+    resample_phase_shift = samplerate_in / (samplerate_out * rate_adjustment);
   }
 
 protected:
   std::shared_ptr<WriteStream<T>> output;
   
   float resample_phase_shift = 1;
+
+private:
+  float samplerate_in = 1;
+  float samplerate_out = 1;
+  float rate_adjustment = 1;
 };
 
 template <typename T>
@@ -23,6 +23,7 @@ struct RingBuffer : Stream<T> {
   }
 
   auto Available() -> int { return count; }
+  auto Capacity() -> int { return length; }
 
   void Reset() {
     rd_ptr = 0;
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2024 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <nba/common/compiler.hpp>
+#include <nba/integer.hpp>
+#include <nba/log.hpp>
+#include <utility>
+#include <vector>
+
+namespace nba {
+
+/**
+ * A fixed-size block of emulated memory on the heap.
+ * Copying a block copies its contents, but two blocks of the same size can exchange their contents in O(1) with swap().
+ * This allows snapshots of the emulated state to take over the memories of the core without copying them.
+ *
+ * Optionally the block tracks which of its pages have been written.
+ * Writes through data() are not tracked, so whoever writes to the block must call MarkDirty().
+ */
+struct StateBlock {
+  static constexpr int kPageShift = 8;
+  static constexpr size_t kPageSize = 1 << kPageShift;
+
+  StateBlock() = default;
+
+  explicit StateBlock(size_t size) : buffer{new u8[size]}, length{size} {}
+
+  StateBlock(StateBlock const& other) : StateBlock{other.length} {
+    std::memcpy(buffer.get(), other.buffer.get(), length);
+  }
+
+  StateBlock(StateBlock&& other) = default;
+
+  auto operator=(StateBlock const& other) -> StateBlock& {
+    Assert(length == other.length, "StateBlock: cannot copy between blocks of different size");
+
+    if(this != &other) {
+      std::memcpy(buffer.get(), other.buffer.get(), length);
+      MarkAllDirty();
+    }
+    return *this;
+  }
+
+  auto operator=(StateBlock&& other) -> StateBlock& = default;
+
+  auto operator[](size_t index) -> u8& {
+    return buffer[index];
+  }
+
+  auto operator[](size_t index) const -> u8 {
+    return buffer[index];
+  }
+
+  auto data() -> u8* {
+    return buffer.get();
+  }
+
+  auto data() const -> u8 const* {
+    return buffer.get();
+  }
+
+  auto size() const -> size_t {
+    return length;
+  }
+
+  void fill(u8 value) {
+    std::memset(buffer.get(), value, length);
+    MarkAllDirty();
+  }
+
+  // The dirty page bitmaps are not exchanged, instead all pages of both blocks are marked dirty.
+  void swap(StateBlock& other) {
+    Assert(length == other.length, "StateBlock: cannot swap blocks of different size");
+
+    std::swap(buffer, other.buffer);
+    MarkAllDirty();
+    other.MarkAllDirty();
+  }
+
+  void Load(void const* data) {
+    std::memcpy(buffer.get(), data, length);
+    MarkAllDirty();
+  }
+
+  void Store(void* data) const {
+    std::memcpy(data, buffer.get(), length);
+  }
+
+  auto IsDirtyTrackingEnabled() const -> bool {
+    return dirty_tracking;
+  }
+
+  void SetDirtyTrackingEnabled(bool enabled) {
+    const size_t page_count = enabled ? length >> kPageShift : 0;
+
+    dirty_tracking = enabled;
+    dirty_map.assign(page_count, 0);
+    dirty_pages.assign((page_count + 63) / 64, 0);
+  }
+
+  // Bit N is set if page N has been written since the last call to ClearDirtyPages().
+  auto GetDirtyPages() -> std::vector<u64> const& {
+    std::fill(dirty_pages.begin(), dirty_pages.end(), 0);
+
+    for(size_t page = 0; page < dirty_map.size(); page++) {
+      dirty_pages[page >> 6] |= (u64)dirty_map[page] << (page & 63);
+    }
+    return dirty_pages;
+  }
+
+  void ClearDirtyPages() {
+    std::fill(dirty_map.begin(), dirty_map.end(), 0);
+  }
+
+  // A plain byte store per write, the bitmap is only assembled by GetDirtyPages().
+  void ALWAYS_INLINE MarkDirty(size_t offset) {
+    if(dirty_tracking) {
+      dirty_map[offset >> kPageShift] = 1;
+    }
+  }
+
+  void MarkDirty(size_t offset, size_t size) {
+    if(dirty_tracking && size != 0) {
+      const size_t first_page = offset >> kPageShift;
+      const size_t last_page = (offset + size - 1) >> kPageShift;
+
+      std::memset(&dirty_map[first_page], 1, last_page - first_page + 1);
+    }
+  }
+
+  void MarkAllDirty() {
+    MarkDirty(0, length);
+  }
+
+private:
+  std::unique_ptr<u8[]> buffer;
+  size_t length = 0;
+  bool dirty_tracking = false;
+  std::vector<u8> dirty_map; // one byte per page, which is set when the page is written
+  std::vector<u64> dirty_pages;
+};
+
+} // namespace nba
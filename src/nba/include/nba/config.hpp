@@ -11,6 +11,8 @@
 #include <nba/device/audio_device.hpp>
 #include <nba/device/video_device.hpp>
 #include <nba/integer.hpp>
+#include <nba/profiler.hpp>
+#include <nba/tracer.hpp>
 #include <string>
 
 namespace nba {
@@ -18,6 +20,16 @@ namespace nba {
 struct Config {
   bool skip_bios = false;
 
+  // Execute common BIOS calls natively. If no BIOS image is attached, a minimal replacement BIOS is used.
+  bool bios_hle = false;
+
+  /**
+   * Marks the following frames as not displayed: the PPU skips the color resolution and output of each pixel,
+   * but still emulates everything the emulated program can observe. Takes effect with the next scanline,
+   * frames which were not fully composed are not presented.
+   */
+  bool skip_frame_composition = false;
+
   enum class BackupType {
     Detect,
     None,
@@ -43,10 +55,19 @@ struct Config {
     bool mp2k_hle_enable = false;
     bool mp2k_hle_cubic = true;
     bool mp2k_hle_force_reverb = true;
+
+    // Resample up to 0.5% faster or slower, to keep the audio buffer half full despite host clock drift.
+    bool dynamic_rate_control = false;
   } audio;
 
   std::shared_ptr<AudioDevice> audio_dev = std::make_shared<NullAudioDevice>();
   std::shared_ptr<VideoDevice> video_dev = std::make_shared<NullVideoDevice>();
+
+  // Guest code profiler, only active when set.
+  std::shared_ptr<Profiler> profiler;
+
+  // Timeline tracer, only active when set.
+  std::shared_ptr<Tracer> tracer;
 };
 
 } // namespace nba
@@ -15,6 +15,7 @@
 #include <nba/integer.hpp>
 #include <nba/save_state.hpp>
 #include <nba/scheduler.hpp>
+#include <nba/snapshot.hpp>
 #include <vector>
 
 namespace nba {
@@ -33,6 +34,15 @@ enum class Key : u8 {
   Count = 10
 };
 
+enum class MemoryRegion : u8 {
+  WRAM = 0,
+  IRAM = 1,
+  PRAM = 2,
+  OAM = 3,
+  VRAM = 4,
+  Count = 5
+};
+
 struct CoreBase {
   static constexpr int kCyclesPerFrame = 280896;
 
@@ -46,9 +56,35 @@ struct CoreBase {
   virtual auto CreateSolarSensor() -> std::unique_ptr<SolarSensor> = 0;
   virtual void LoadState(SaveState const& state) = 0;
   virtual void CopyState(SaveState& state) = 0;
+
+  /**
+   * Snapshots are a cheaper alternative to save states for rewind, run-ahead and rollback.
+   * If there is no other reference to the snapshot, LoadSnapshot() takes over its memories instead of copying them
+   * and the snapshot is recycled by the next CreateSnapshot(). Pass the handle with std::move() to allow that.
+   * CopySnapshot() updates an existing snapshot in place.
+   */
+  virtual auto CreateSnapshot() -> SnapshotHandle = 0;
+  virtual void CopySnapshot(Snapshot& snapshot) = 0;
+  virtual void LoadSnapshot(SnapshotHandle snapshot) = 0;
+
+  /**
+   * Dirty page tracking records which pages (StateBlock::kPageSize bytes) of the emulated memories have been written.
+   * Loading a save state or snapshot marks all pages dirty. Bit N of the bitmap corresponds to page N.
+   */
+  virtual void SetDirtyTrackingEnabled(bool enabled) = 0;
+  virtual auto GetDirtyPages(MemoryRegion region) -> std::vector<u64> const& = 0;
+  virtual void ClearDirtyPages(MemoryRegion region) = 0;
+
   virtual void SetKeyStatus(Key key, bool pressed) = 0;
   virtual void Run(int cycles) = 0;
 
+  // Suppress output to the video and audio devices, for example while running ahead of the displayed frame.
+  virtual void SetVideoEnabled(bool enabled) = 0;
+  virtual void SetAudioEnabled(bool enabled) = 0;
+
+  // Returns how full the buffer between the emulated APU and the audio device is, from 0 (empty) to 1 (full).
+  virtual auto GetAudioBufferFill() -> float = 0;
+
   virtual auto GetROM() -> ROM& = 0;
   virtual auto GetPRAM() -> u8* = 0;
   virtual auto GetVRAM() -> u8* = 0;
@@ -62,6 +98,9 @@ struct CoreBase {
 
   virtual core::Scheduler& GetScheduler() = 0;
 
+  // The configuration the core was created with. It may be changed at runtime, for example to skip frame composition.
+  virtual auto GetConfig() -> Config& = 0;
+
   void RunForOneFrame() {
     Run(kCyclesPerFrame);
   }
@@ -7,10 +7,16 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <cstring>
 #include <fmt/color.h>
 #include <fmt/format.h>
 #include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
 namespace nba {
 
@@ -33,43 +39,121 @@ namespace detail {
   static constexpr int kLogMask = All;
 #endif
 
+/**
+ * Log messages are handed to a background writer thread through a lock-free ring buffer.
+ * If all arguments are arithmetic values, they are copied into the record and formatting is deferred to the writer thread.
+ * The format string is copied along with them, because it need not outlive the call either.
+ * Otherwise (for example for strings which may not outlive the call) the message is formatted on the calling thread.
+ */
+struct LogRecord {
+  // Large enough to hold a full mGBA debug log message (256 characters) and its prefix.
+  static constexpr size_t kDataSize = 280;
+
+  using FormatFn = void (*)(fmt::memory_buffer& buffer, std::string_view format, char const* data);
+
+  Level level;
+  FormatFn format_fn;
+  size_t size;
+  size_t format_size; // of a deferred message, whose format string follows the arguments in data
+  char data[kDataSize];
+};
+
+extern std::atomic<int> g_log_mask;
+
+bool LogShouldRateLimit(char const* site);
+void LogPush(LogRecord const& record);
+void LogWriteSync(Level level, std::string_view message);
+
+template<typename... Args>
+void LogFormatDeferred(fmt::memory_buffer& buffer, std::string_view format, char const* data) {
+  std::tuple<Args...> args{};
+  size_t offset = 0;
+
+  std::apply([&](auto&... arg) {
+    ((std::memcpy(&arg, data + offset, sizeof(arg)), offset += sizeof(arg)), ...);
+  }, args);
+
+  std::apply([&](auto const&... arg) {
+    fmt::vformat_to(std::back_inserter(buffer), format, fmt::make_format_args(arg...));
+  }, args);
+}
+
 } // namespace nba::detail
 
-template<Level level, typename... Args>
-inline void Log(std::string_view format, Args&&... args) {
-  if constexpr((detail::kLogMask & level) != 0) {
-    fmt::text_style style = {};
-    char const* prefix = "[?]";
+inline void SetLogMask(int mask) {
+  detail::g_log_mask.store(mask, std::memory_order_relaxed);
+}
 
-    if constexpr(level == Trace) {
-      style = fmt::fg(fmt::terminal_color::cyan);
-      prefix = "[T]";
-    }
-    if constexpr(level == Debug) {
-      style = fmt::fg(fmt::terminal_color::blue);
-      prefix = "[D]";
-    }
-    if constexpr(level ==  Info) {
-      prefix = "[I]";
-    }
-    if constexpr(level ==  Warn) {
-      style = fmt::fg(fmt::terminal_color::yellow);
-      prefix = "[W]";
-    }
-    if constexpr(level == Error) {
-      style = fmt::fg(fmt::terminal_color::magenta);
-      prefix = "[E]";
+inline auto GetLogMask() -> int {
+  return detail::g_log_mask.load(std::memory_order_relaxed);
+}
+
+// Blocks until all queued log messages have been written.
+void FlushLog();
+
+namespace detail {
+
+template<Level level, bool rate_limit, typename... Args>
+inline void LogImpl(std::string_view format, Args&&... args) {
+  if constexpr((detail::kLogMask & level) != 0) {
+    if((GetLogMask() & level) == 0) {
+      return;
     }
+
     if constexpr(level == Fatal) {
-      style = fmt::fg(fmt::terminal_color::red);
-      prefix = "[F]";
-    }
+      detail::LogWriteSync(level, fmt::vformat(format, fmt::make_format_args(args...)));
+    } else {
+      if(rate_limit && detail::LogShouldRateLimit(format.data())) {
+        return;
+      }
+
+      detail::LogRecord record;
+
+      record.level = level;
+
+      bool deferred = false;
+
+      if constexpr(((std::is_arithmetic_v<std::decay_t<Args>>) && ...)) {
+        constexpr size_t args_size = (sizeof(std::decay_t<Args>) + ... + 0);
+
+        if(args_size + format.size() <= detail::LogRecord::kDataSize) {
+          size_t offset = 0;
+
+          ((std::memcpy(&record.data[offset], &args, sizeof(args)), offset += sizeof(args)), ...);
+          std::memcpy(&record.data[offset], format.data(), format.size());
+
+          record.format_fn = &detail::LogFormatDeferred<std::decay_t<Args>...>;
+          record.size = offset;
+          record.format_size = format.size();
+          deferred = true;
+        }
+      }
+
+      if(!deferred) {
+        const auto result = fmt::vformat_to_n(record.data, sizeof(record.data), format, fmt::make_format_args(args...));
 
-    const auto& style_ref = style;
-    fmt::print(style_ref, "{} {}\n", prefix, fmt::vformat(format, fmt::make_format_args(args...)));
+        record.format_fn = nullptr;
+        record.size = std::min(result.size, sizeof(record.data));
+      }
+
+      detail::LogPush(record);
+    }
   }
 }
 
+} // namespace nba::detail
+
+template<Level level, typename... Args>
+inline void Log(std::string_view format, Args&&... args) {
+  detail::LogImpl<level, true>(format, std::forward<Args>(args)...);
+}
+
+// Like Log(), but never rate limited. For output that the emulated program requests, like the mGBA debug log.
+template<Level level, typename... Args>
+inline void LogUnlimited(std::string_view format, Args&&... args) {
+  detail::LogImpl<level, false>(format, std::forward<Args>(args)...);
+}
+
 template<typename... Args>
 inline void Assert(bool condition, Args&&... args) {
   if(!condition) {
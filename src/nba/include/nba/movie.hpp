@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2024 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <nba/core.hpp>
+#include <nba/integer.hpp>
+#include <nba/save_state.hpp>
+#include <vector>
+
+namespace nba {
+
+/**
+ * An input movie is a sequence of key events, each tagged with the scheduler timestamp at which it was applied.
+ * The core is deterministic and Core::Run() always stops at the first instruction boundary at or after the target timestamp,
+ * so replaying a movie by running up to each event's timestamp reproduces the recording bit-exactly.
+ *
+ * Binary format (all integers little-endian):
+ *   u32 magic, u32 version, u32 ROM CRC32, u32 BIOS CRC32, u64 start timestamp, u64 length in cycles,
+ *   u32 flags, u32 event count, [SaveState if flags & kFlagSaveState], events...
+ * Each event is encoded as a LEB128 timestamp delta (relative to the previous event) followed by one byte
+ * holding the key (bits 0 - 6) and the pressed state (bit 7).
+ */
+struct InputMovie {
+  static constexpr u32 kMagicNumber = 0x4D41424E; // NBAM
+  static constexpr u32 kCurrentVersion = 1;
+
+  static constexpr u32 kFlagSaveState = 1;
+
+  enum class Result {
+    CannotOpen,
+    BadImage,
+    UnsupportedVersion,
+    Success
+  };
+
+  struct Event {
+    u64 timestamp;
+    Key key;
+    bool pressed;
+  };
+
+  u32 rom_crc32 = 0;
+  u32 bios_crc32 = 0;
+  u64 start_timestamp = 0;
+  u64 length = 0;
+
+  // The state to start playback from. If not set, playback starts from a reset.
+  std::unique_ptr<SaveState> save_state;
+
+  std::vector<Event> events;
+
+  void Encode(std::vector<u8>& data) const;
+  auto Decode(std::vector<u8> const& data) -> Result;
+
+  static auto CalculateCRC32(std::vector<u8> const& data) -> u32;
+};
+
+struct MovieRecorder {
+  // Starts recording from the current state of the core, or from a reset if from_save_state is false.
+  void Start(CoreBase& core, std::vector<u8> const& bios, bool from_save_state);
+
+  // Applies the key status to the core and records it into the movie.
+  void SetKeyStatus(CoreBase& core, Key key, bool pressed);
+
+  auto Stop(CoreBase& core) -> InputMovie&;
+
+  bool IsRecording() const { return recording; }
+
+  auto GetMovie() -> InputMovie& { return movie; }
+
+private:
+  InputMovie movie;
+  bool recording = false;
+};
+
+struct MoviePlayer {
+  enum class Result {
+    ROMMismatch,
+    BIOSMismatch,
+    Success
+  };
+
+  // Puts the core into the movie's initial state. The movie must outlive the playback.
+  auto Start(CoreBase& core, InputMovie const& movie, std::vector<u8> const& bios) -> Result;
+
+  // Runs the core for the given number of cycles (or until the end of the movie), applying recorded inputs at their exact timestamp.
+  void Run(CoreBase& core, int cycles);
+
+  bool IsFinished(CoreBase& core) const;
+
+private:
+  InputMovie const* movie = nullptr;
+  size_t next_event = 0;
+};
+
+} // namespace nba
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2024 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#pragma once
+
+#include <map>
+#include <nba/integer.hpp>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+namespace nba {
+
+/**
+ * Sampling profiler for guest code.
+ * Every N emulated cycles the address of the executing instruction is sampled into a histogram.
+ * Additionally BL instructions, SWIs and IRQs are followed to maintain a shadow call stack,
+ * which is used to build a guest call graph and collapsed stacks (as consumed by flamegraph.pl, speedscope, etc.)
+ */
+struct Profiler {
+  static constexpr int kMaxStackDepth = 128;
+
+  Profiler(int sample_interval = 1024) : sample_interval(sample_interval) {
+    Reset();
+  }
+
+  void Reset();
+
+  void Sample(u64 timestamp, u32 address) {
+    if(timestamp >= timestamp_next_sample) {
+      Record(address);
+      timestamp_next_sample = timestamp + sample_interval;
+    }
+  }
+
+  void OnCall(u32 function, u32 return_address);
+  void OnBranch(u32 address);
+
+  auto GetSampleCount() const -> u64 { return sample_count; }
+
+  void WriteHistogram(std::ostream& stream) const;
+  void WriteCallGraph(std::ostream& stream) const;
+  void WriteCollapsedStacks(std::ostream& stream) const;
+
+private:
+  struct Frame {
+    u32 function;
+    u32 return_address;
+  };
+
+  void Record(u32 address);
+
+  int sample_interval;
+  u64 timestamp_next_sample;
+  u64 sample_count;
+
+  std::vector<Frame> stack;
+  std::unordered_map<u32, u64> histogram;
+  std::unordered_map<u64, u64> call_edges;
+  std::map<std::vector<u32>, u64> stacks;
+};
+
+} // namespace nba
@@ -16,7 +16,7 @@ namespace nba {
 
 struct SaveState {
   static constexpr u32 kMagicNumber = 0x5353424E; // NBSS
-  static constexpr u32 kCurrentVersion = 10;
+  static constexpr u32 kCurrentVersion = 11;
 
   u32 magic;
   u32 version;
@@ -304,6 +304,10 @@ struct SaveState {
 
   u16 keycnt;
 
+  struct HLE {
+    bool bios_intr_wait_pending;
+  } hle;
+
   struct Scheduler {
     struct Event {
       u64 key;
@@ -317,4 +321,16 @@ struct SaveState {
   } scheduler;
 };
 
+/**
+ * Upgrades a save state of an older version, whose structure layout is
+ * otherwise identical, to the current version. Other versions are left alone.
+ * Version 11 added the HLE section, which used to be structure padding.
+ */
+inline void UpgradeSaveState(SaveState& state) {
+  if(state.version == 10) {
+    state.hle = {};
+    state.version = SaveState::kCurrentVersion;
+  }
+}
+
 } // namespace nba
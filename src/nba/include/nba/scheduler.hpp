@@ -11,6 +11,7 @@
 #include <nba/common/compiler.hpp>
 #include <nba/integer.hpp>
 #include <nba/save_state.hpp>
+#include <nba/tracer.hpp>
 #include <functional>
 #include <limits>
 
@@ -116,6 +117,14 @@ struct Scheduler {
     Add(std::numeric_limits<u64>::max(), EventClass::EndOfQueue);
   }
 
+  auto GetTracer() -> Tracer* {
+    return tracer;
+  }
+
+  void SetTracer(Tracer* tracer) {
+    this->tracer = tracer;
+  }
+
   auto GetTimestampNow() const -> u64 {
     return timestamp_now;
   }
@@ -250,7 +259,13 @@ private:
     while(heap[0]->timestamp <= timestamp_next && heap_size > 0) {
       auto event = heap[0];
       timestamp_now = event->timestamp;
-      callbacks[(int)event->event_class](event->user_data);
+      if(unlikely(tracer != nullptr)) {
+        auto span = tracer->BeginSpan(Tracer::Type::Event, timestamp_now, (u16)event->event_class);
+        callbacks[(int)event->event_class](event->user_data);
+        tracer->EndSpan(span);
+      } else {
+        callbacks[(int)event->event_class](event->user_data);
+      }
       Remove(event->handle);
     }
   }
@@ -301,6 +316,7 @@ private:
   int heap_size;
   u64 timestamp_now;
   u64 next_uid;
+  Tracer* tracer = nullptr;
 
   std::function<void(u64)> callbacks[(int)EventClass::Count];
 };
@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2024 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <nba/common/state_block.hpp>
+#include <nba/save_state.hpp>
+
+namespace nba {
+
+/**
+ * In-memory snapshot of the emulated state, for rewind, run-ahead and rollback.
+ * Unlike a SaveState the large memories are kept in state blocks, which the core can take over without copying them.
+ */
+struct Snapshot {
+  /* All state except for the memories below. The memory arrays of the save state are left unused.
+   * The cartridge backup is still copied through SaveState::backup, since it lives in the BackupFile
+   * of the save type (between 512 bytes and 128 KiB), which writes through to the save file on disk.
+   */
+  SaveState state;
+
+  struct Memory {
+    StateBlock wram{0x40000};
+    StateBlock iram{0x08000};
+    StateBlock pram{0x00400};
+    StateBlock oam {0x00400};
+    StateBlock vram{0x18000};
+  } memory;
+};
+
+using SnapshotHandle = std::shared_ptr<Snapshot>;
+
+} // namespace nba
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2024 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <nba/integer.hpp>
+#include <ostream>
+#include <vector>
+
+namespace nba {
+
+/**
+ * Records a timeline of emulator events (scheduler event dispatch, DMA transfers, IRQs, HALT and frames)
+ * into a lock-free single-producer single-consumer ring buffer.
+ * The emulator thread is the only producer, any other thread may drain the buffer and
+ * serialize the records to the Chrome JSON trace format (chrome://tracing, Perfetto).
+ */
+struct Tracer {
+  enum class Type : u8 {
+    Event,
+    DMA,
+    IRQ,
+    Halt,
+    Frame
+  };
+
+  struct Record {
+    u64 timestamp;
+    u64 host_time;
+    u32 host_duration;
+    u16 arg;
+    Type type;
+  };
+
+  // @param capacity  number of records in the ring buffer, must be a power of two.
+  Tracer(size_t capacity = 1 << 20);
+
+  auto GetHostTime() const -> u64 {
+    return (u64)std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - host_time_base).count();
+  }
+
+  void Add(Type type, u64 timestamp, u16 arg = 0) {
+    Push({timestamp, GetHostTime(), 0, arg, type});
+  }
+
+  auto BeginSpan(Type type, u64 timestamp, u16 arg = 0) const -> Record {
+    return {timestamp, GetHostTime(), 0, arg, type};
+  }
+
+  void EndSpan(Record& record) {
+    record.host_duration = (u32)(GetHostTime() - record.host_time);
+    Push(record);
+  }
+
+  auto Read(std::vector<Record>& records) -> size_t;
+
+  auto GetDropCount() const -> u64 {
+    return drop_count.load(std::memory_order_relaxed);
+  }
+
+  static void WriteChromeTrace(std::ostream& stream, std::vector<Record> const& records);
+
+private:
+  void Push(Record const& record) {
+    const u64 head = this->head.load(std::memory_order_relaxed);
+
+    if(head - tail.load(std::memory_order_acquire) == buffer.size()) {
+      drop_count.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    buffer[head & mask] = record;
+    this->head.store(head + 1, std::memory_order_release);
+  }
+
+  std::vector<Record> buffer;
+  u64 mask;
+  std::chrono::steady_clock::time_point host_time_base;
+
+  alignas(64) std::atomic<u64> head = 0;
+  alignas(64) std::atomic<u64> tail = 0;
+  std::atomic<u64> drop_count = 0;
+};
+
+} // namespace nba
@@ -11,10 +11,12 @@
 #include <algorithm>
 #include <nba/common/compiler.hpp>
 #include <nba/log.hpp>
+#include <nba/profiler.hpp>
 #include <nba/save_state.hpp>
 #include <nba/scheduler.hpp>
 
 #include "bus/bus.hpp"
+#include "bus/hle/bios.hpp"
 #include "arm/state.hpp"
 
 /**
@@ -53,6 +55,14 @@ struct ARM7TDMI {
     cpu_mode_is_invalid = false;
   }
 
+  void SetProfiler(Profiler* profiler) {
+    this->profiler = profiler;
+  }
+
+  void SetBIOSHLE(BIOSHLE* bios_hle) {
+    this->bios_hle = bios_hle;
+  }
+
   auto GetFetchedOpcode(int slot) -> u32 {
     return pipe.opcode[slot];
   }
@@ -60,6 +70,10 @@ struct ARM7TDMI {
   void Run() {
     if(IRQLine()) SignalIRQ();
 
+    if(unlikely(profiler != nullptr)) {
+      profiler->Sample(scheduler.GetTimestampNow(), state.r15 - (state.cpsr.f.thumb ? 4 : 8));
+    }
+
     auto instruction = pipe.opcode[0];
 
     latch_irq_disable = state.cpsr.f.mask_irq;
@@ -221,11 +235,34 @@ private:
       SetReg(14, state.r15 - 4);
     }
 
+    if(unlikely(profiler != nullptr)) {
+      profiler->OnCall(0x18, state.r14 - 4);
+    }
+
     // Jump to IRQ exception vector.
     state.r15 = 0x18;
     ReloadPipeline32();
   }
 
+  bool HandleSWI_HLE(u8 number, u32 return_address) {
+    const u32 r15 = state.r15;
+
+    state.r15 = return_address;
+
+    if(!bios_hle->HandleSWI(*this, number)) {
+      state.r15 = r15;
+      return false;
+    }
+
+    // The HLE routine may have modified the code at the return address (or changed the return address).
+    if(state.cpsr.f.thumb) {
+      ReloadPipeline16();
+    } else {
+      ReloadPipeline32();
+    }
+    return true;
+  }
+
   bool CheckCondition(Condition condition) {
     if(condition == COND_AL)
       return true;
@@ -233,6 +270,10 @@ private:
   }
 
   void ReloadPipeline16() {
+    if(unlikely(profiler != nullptr)) {
+      profiler->OnBranch(state.r15);
+    }
+
     pipe.opcode[0] = bus.ReadHalf(state.r15 + 0, Access::Code | Access::Nonsequential);
     pipe.opcode[1] = bus.ReadHalf(state.r15 + 2, Access::Code | Access::Sequential);
     pipe.access = Access::Code | Access::Sequential;
@@ -242,6 +283,10 @@ private:
   }
 
   void ReloadPipeline32() {
+    if(unlikely(profiler != nullptr)) {
+      profiler->OnBranch(state.r15);
+    }
+
     pipe.opcode[0] = bus.ReadWord(state.r15 + 0, Access::Code | Access::Nonsequential);
     pipe.opcode[1] = bus.ReadWord(state.r15 + 4, Access::Code | Access::Sequential);
     pipe.access = Access::Code | Access::Sequential;
@@ -293,6 +338,9 @@ private:
   bool irq_line;
   bool latch_irq_disable;
 
+  Profiler* profiler = nullptr;
+  BIOSHLE* bios_hle = nullptr;
+
   static std::array<bool, 256> s_condition_lut;
   static std::array<Handler16, 1024> s_opcode_lut_16;
   static std::array<Handler32, 4096> s_opcode_lut_32;
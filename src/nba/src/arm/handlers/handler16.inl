@@ -568,6 +568,10 @@ void Thumb_ConditionalBranch(u16 instruction) {
 }
 
 void Thumb_SWI(u16 instruction) {
+  if (unlikely(bios_hle != nullptr) && HandleSWI_HLE(instruction & 0xFF, state.r15 - 2)) {
+    return;
+  }
+
   // Save current program status register.
   state.spsr[BANK_SVC].v = state.cpsr.v;
 
@@ -579,6 +583,9 @@ void Thumb_SWI(u16 instruction) {
   // Save current program counter and jump to SVC exception vector.
   state.r14 = state.r15 - 2;
   state.r15 = 0x08;
+  if (unlikely(profiler != nullptr)) {
+    profiler->OnCall(0x08, state.r14);
+  }
   ReloadPipeline32();
 }
 
@@ -611,6 +618,9 @@ void Thumb_LongBranchLink(u16 instruction) {
 
     state.r15 = (state.r14 + imm * 2) & ~1;
     state.r14 = temp | 1;
+    if (unlikely(profiler != nullptr)) {
+      profiler->OnCall(state.r15, temp);
+    }
     ReloadPipeline16();
   }
 }
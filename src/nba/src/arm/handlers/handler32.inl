@@ -468,6 +468,10 @@ void ARM_BranchAndLink(u32 instruction) {
 
   if (link) {
     SetReg(14, state.r15 - 4);
+
+    if (unlikely(profiler != nullptr)) {
+      profiler->OnCall(state.r15 + offset * 4, state.r15 - 4);
+    }
   }
 
   state.r15 += offset * 4;
@@ -680,6 +684,10 @@ void ARM_Undefined(u32 instruction) {
 }
 
 void ARM_SWI(u32 instruction) {
+  if (unlikely(bios_hle != nullptr) && HandleSWI_HLE((instruction >> 16) & 0xFF, state.r15 - 4)) {
+    return;
+  }
+
   // Save current program status register.
   state.spsr[BANK_SVC].v = state.cpsr.v;
 
@@ -687,6 +695,10 @@ void ARM_SWI(u32 instruction) {
   SwitchMode(MODE_SVC);
   state.cpsr.f.mask_irq = 1;
 
+  if (unlikely(profiler != nullptr)) {
+    profiler->OnCall(0x08, state.r15 - 4);
+  }
+
   // Save current program counter and jump to SVC exception vector.
   SetReg(14, state.r15 - 4);
   state.r15 = 0x08;
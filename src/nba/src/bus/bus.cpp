@@ -204,12 +204,14 @@ void Bus::Write(u32 address, int access, T value) {
     case 0x02: {
       Step(is_u32 ? 6 : 3);
       write<T>(memory.wram.data(), Align<T>(address) & 0x3FFFF, value);
+      memory.wram.MarkDirty(address & 0x3FFFF);
       break;
     }
     // IWRAM (internal work RAM)
     case 0x03: {
       Step(1);
       write<T>(memory.iram.data(), Align<T>(address) & 0x7FFF,  value);
+      memory.iram.MarkDirty(address & 0x7FFF);
       break;
     }
     // MMIO
@@ -374,6 +376,18 @@ auto Bus::ReadOpenBus(u32 address) -> u32 {
   return word >> shift;
 }
 
+void Bus::MarkDirty(u32 address, size_t size) {
+  const u32 offset = address & 0x00FF'FFFF;
+
+  switch(address >> 24) {
+    case 0x02: memory.wram.MarkDirty(offset, size); break;
+    case 0x03: memory.iram.MarkDirty(offset, size); break;
+    case 0x05: hw.ppu.GetPRAMBlock().MarkDirty(offset, size); break;
+    case 0x06: hw.ppu.GetVRAMBlock().MarkDirty(offset, size); break;
+    case 0x07: hw.ppu.GetOAMBlock().MarkDirty(offset, size); break;
+  }
+}
+
 auto Bus::GetHostAddress(u32 address, size_t size) -> u8* {
   auto& bios = memory.bios;
   auto& wram = memory.wram;
@@ -8,9 +8,11 @@
 #pragma once
 
 #include <array>
+#include <nba/common/state_block.hpp>
 #include <nba/rom/rom.hpp>
 #include <nba/integer.hpp>
 #include <nba/save_state.hpp>
+#include <nba/snapshot.hpp>
 #include <vector>
 
 #include "hw/apu/apu.hpp"
@@ -54,8 +56,8 @@ struct Bus {
 
   struct Memory {
     std::array<u8, 0x04000> bios;
-    std::array<u8, 0x40000> wram;
-    std::array<u8, 0x08000> iram;
+    StateBlock wram{0x40000};
+    StateBlock iram{0x08000};
     struct Latch {
       u32 bios = 0;
     } latch;
@@ -108,14 +110,19 @@ struct Bus {
     void WriteWord(u32 address, u32 value);
   } hw;
 
+  /**
+   * The buffer fill level is not updated on every bus cycle.
+   * Instead it is derived from the time at which the opcode in flight completes, see SyncPrefetch().
+   */
   struct Prefetch {
     bool active = false;
+    bool stalled = false;
     u32 head_address;
     u32 last_address;
     int count = 0;
     int capacity = 8;
     int opcode_width = 4;
-    int countdown;
+    u64 timestamp_due;
     int duty;
     bool thumb;
   } prefetch;
@@ -134,15 +141,50 @@ struct Bus {
     return address & ~(sizeof(T) - 1);
   }
 
+  /**
+   * Video memory accesses stall while the PPU accesses the same memory in the same cycle.
+   * Only the engine owning the memory is synchronized and the check is skipped altogether
+   * while that engine is idle (V-blank, forced blank or the layers are disabled).
+   */
+  void ALWAYS_INLINE WaitPRAM() noexcept {
+    // The merge engine depends on the output of all other engines.
+    do {
+      Step(1);
+      if(hw.ppu.IsMergeIdle()) break;
+      hw.ppu.Sync();
+    } while(hw.ppu.DidAccessPRAM());
+  }
+
+  void ALWAYS_INLINE WaitVRAM_BG() noexcept {
+    do {
+      Step(1);
+      if(hw.ppu.IsBackgroundIdle()) break;
+      hw.ppu.SyncBackground();
+    } while(hw.ppu.DidAccessVRAM_BG());
+  }
+
+  void ALWAYS_INLINE WaitVRAM_OBJ() noexcept {
+    do {
+      Step(1);
+      if(hw.ppu.IsSpriteIdle()) break;
+      hw.ppu.SyncSprite();
+    } while(hw.ppu.DidAccessVRAM_OBJ());
+  }
+
+  void ALWAYS_INLINE WaitOAM() noexcept {
+    do {
+      Step(1);
+      if(hw.ppu.IsSpriteIdle()) break;
+      hw.ppu.SyncSprite();
+    } while(hw.ppu.DidAccessOAM());
+  }
+
   template<typename T>
   auto ALWAYS_INLINE ReadPRAM(u32 address) noexcept -> T {
     constexpr int cycles = std::is_same_v<T, u32> ? 2 : 1;
 
     for(int i = 0; i < cycles; i++) {
-      do {
-        Step(1);
-        hw.ppu.Sync();
-      } while(hw.ppu.DidAccessPRAM());
+      WaitPRAM();
     }
 
     return hw.ppu.ReadPRAM<T>(address);
@@ -151,11 +193,7 @@ struct Bus {
   template<typename T>
   void ALWAYS_INLINE WritePRAM(u32 address, T value) noexcept {
     if constexpr (!std::is_same_v<T, u32>) {
-      do {
-        Step(1);
-        hw.ppu.Sync();
-      } while(hw.ppu.DidAccessPRAM());
-
+      WaitPRAM();
       hw.ppu.WritePRAM<T>(address, value);
     } else {
       WritePRAM(address + 0, (u16)(value >>  0));
@@ -173,19 +211,13 @@ struct Bus {
 
     if(address >= boundary) {
       for(int i = 0; i < cycles; i++) {
-        do {
-          Step(1);
-          hw.ppu.Sync();
-        } while(hw.ppu.DidAccessVRAM_OBJ());
+        WaitVRAM_OBJ();
       }
 
       return hw.ppu.ReadVRAM_OBJ<T>(address, boundary);
     } else {
       for(int i = 0; i < cycles; i++) {
-        do {
-          Step(1);
-          hw.ppu.Sync();
-        } while(hw.ppu.DidAccessVRAM_BG());
+        WaitVRAM_BG();
       }
 
       return hw.ppu.ReadVRAM_BG<T>(address);
@@ -200,20 +232,10 @@ struct Bus {
       address &= 0x1FFFF;
 
       if(address >= boundary) {
-        // TODO: de-duplicate this code (see ReadVRAM):
-        do {
-          Step(1);
-          hw.ppu.Sync();
-        } while(hw.ppu.DidAccessVRAM_OBJ());
-
+        WaitVRAM_OBJ();
         hw.ppu.WriteVRAM_OBJ<T>(address, value, boundary);
       } else {
-        // TODO: de-duplicate this code (see ReadVRAM):
-        do {
-          Step(1);
-          hw.ppu.Sync();
-        } while(hw.ppu.DidAccessVRAM_BG());
-
+        WaitVRAM_BG();
         hw.ppu.WriteVRAM_BG<T>(address, value);
       }
     } else {
@@ -224,21 +246,13 @@ struct Bus {
 
   template<typename T>
   auto ALWAYS_INLINE ReadOAM(u32 address) noexcept -> T {
-    do {
-      Step(1);
-      hw.ppu.Sync();
-    } while(hw.ppu.DidAccessOAM());
-
+    WaitOAM();
     return hw.ppu.ReadOAM<T>(address);
   }
 
   template<typename T>
   void ALWAYS_INLINE WriteOAM(u32 address, T value) noexcept {
-    do {
-      Step(1);
-      hw.ppu.Sync();
-    } while(hw.ppu.DidAccessOAM());
-
+    WaitOAM();
     hw.ppu.WriteOAM<T>(address, value);
   }
 
@@ -249,11 +263,14 @@ struct Bus {
 
   void Prefetch(u32 address, bool code, int cycles);
   void StopPrefetch();
+  void SyncPrefetch();
   void Step(int cycles);
   void UpdateWaitStateTable();
 
   void LoadState(SaveState const& state);
   void CopyState(SaveState& state);
+  void LoadMemory(Snapshot::Memory& memory, bool swap);
+  void CopyMemory(Snapshot::Memory& memory);
  
   int wait16[2][16] {
     { 1, 1, 3, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1 },
@@ -270,6 +287,9 @@ public:
 
   auto GetHostAddress(u32 address, size_t size) -> u8*;
 
+  // For writes that bypass the bus through a host pointer. The range must not cross the end of the memory.
+  void MarkDirty(u32 address, size_t size);
+
   template<typename T>
   auto GetHostAddress(u32 address, size_t count = 1) -> T* {
     return (T*)GetHostAddress(address, sizeof(T) * count);
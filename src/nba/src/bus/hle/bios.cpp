@@ -0,0 +1,882 @@
+/*
+ * Copyright (C) 2024 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <nba/common/punning.hpp>
+#include <nba/log.hpp>
+
+#include "arm/arm7tdmi.hpp"
+#include "bus/hle/bios.hpp"
+#include "bus/bus.hpp"
+#include "bus/io.hpp"
+
+namespace nba::core {
+
+/**
+ * Approximate cost (in cycles) of the BIOS code that is skipped.
+ * SWI entry, the dispatcher and the return to the caller take roughly 40 cycles.
+ * The loop constants approximate the BIOS instructions executed per unit of work,
+ * excluding the memory accesses which are charged by the bus.
+ */
+static constexpr int kSWICycles = 40;
+static constexpr int kDivLoopCycles = 13;
+static constexpr int kSqrtLoopCycles = 10;
+static constexpr int kArcTanCycles = 70;
+static constexpr int kArcTan2Cycles = 40;
+static constexpr int kCpuSetUnitCycles = 5;
+static constexpr int kCpuFastSetBlockCycles = 6;
+static constexpr int kUnCompByteCycles = 8;
+
+// The value that the BIOS read latch holds after returning from a SWI.
+static constexpr u32 kBIOSLatchAfterSWI = 0xE3A02004;
+
+// Address of the BIOS interrupt flags (mirror of 0x03FFFFF8).
+static constexpr u32 kBIOSIntrFlags = 0x03007FF8;
+
+static constexpr u32 kStubResetVector = 0xE3A0F302; // mov pc, #0x08000000
+
+static constexpr std::pair<u32, u32> kStubBIOS[] {
+  { 0x000, kStubResetVector },
+  { 0x004, 0xE1B0F00E }, // movs pc, lr
+  { 0x008, 0xE1B0F00E }, // movs pc, lr
+  { 0x00C, 0xE25EF004 }, // subs pc, lr, #4
+  { 0x010, 0xE25EF008 }, // subs pc, lr, #8
+  { 0x018, 0xEA000042 }, // b 0x128
+  { 0x01C, 0xE25EF004 }, // subs pc, lr, #4
+  { 0x128, 0xE92D500F }, // stmfd sp!, {r0-r3, r12, lr}
+  { 0x12C, 0xE3A00301 }, // mov r0, #0x04000000
+  { 0x130, 0xE28FE000 }, // add lr, pc, #0
+  { 0x134, 0xE510F004 }, // ldr pc, [r0, #-4]
+  { 0x138, 0xE8BD500F }, // ldmfd sp!, {r0-r3, r12, lr}
+  { 0x13C, 0xE25EF004 }  // subs pc, lr, #4
+};
+
+static auto BitLength(u32 value) -> int {
+  int length = 0;
+
+  while(value != 0) {
+    value >>= 1;
+    length++;
+  }
+  return length;
+}
+
+// Bounds-checked reader for compressed data that is accessed through a host pointer.
+struct HostStream {
+  u8 const* data;
+  u32 size;
+  u32 position = 0;
+  bool overrun = false;
+
+  auto ReadByte() -> u8 {
+    if(position >= size) {
+      overrun = true;
+      return 0;
+    }
+    return data[position++];
+  }
+
+  auto ReadByte(u32 offset) -> u8 {
+    if(offset >= size) {
+      overrun = true;
+      return 0;
+    }
+    return data[offset];
+  }
+
+  auto ReadWord() -> u32 {
+    u32 value = 0;
+
+    for(int i = 0; i < 4; i++) {
+      value |= ReadByte() << (i * 8);
+    }
+    return value;
+  }
+};
+
+// 32-bit multiplication with the wrap-around behaviour of the ARM MUL instruction.
+static auto Mul32(s32 a, s32 b) -> s32 {
+  return (s32)((u32)a * (u32)b);
+}
+
+void BIOSHLE::Reset() {
+  intr_wait_pending = false;
+}
+
+bool BIOSHLE::HandleSWI(arm::ARM7TDMI& cpu, u8 number) {
+  auto& state = cpu.state;
+
+  switch(number) {
+    case 0x00: SoftReset(cpu); break;
+    case 0x01: RegisterRamReset(state.r0); break;
+    case 0x02: {
+      bus.hw.haltcnt = Bus::Hardware::HaltControl::Halt;
+      bus.Step(1);
+      break;
+    }
+    case 0x04: IntrWait(cpu, state.r0 != 0, state.r1); break;
+    case 0x05: {
+      state.r0 = 1;
+      state.r1 = 1;
+      IntrWait(cpu, true, 1);
+      break;
+    }
+    case 0x06: Div(cpu, state.r0, state.r1); break;
+    case 0x07: Div(cpu, state.r1, state.r0); break;
+    case 0x08: Sqrt(cpu); break;
+    case 0x09: ArcTan(cpu); break;
+    case 0x0A: ArcTan2(cpu); break;
+    case 0x0B: CpuSet(state.r0, state.r1, state.r2); break;
+    case 0x0C: CpuFastSet(state.r0, state.r1, state.r2); break;
+    case 0x0D: state.r0 = 0xBAAE187F; break;
+    case 0x11: LZ77UnComp(state.r0, state.r1, false); break;
+    case 0x12: LZ77UnComp(state.r0, state.r1, true); break;
+    case 0x13: HuffUnComp(state.r0, state.r1); break;
+    case 0x14: RLUnComp(state.r0, state.r1, false); break;
+    case 0x15: RLUnComp(state.r0, state.r1, true); break;
+    default: {
+      Log<Trace>("BIOS HLE: SWI 0x{:02X} is handled by the BIOS", number);
+      return false;
+    }
+  }
+
+  Idle(kSWICycles);
+  bus.memory.latch.bios = kBIOSLatchAfterSWI;
+  return true;
+}
+
+bool BIOSHLE::InstallStubBIOS() {
+  auto& bios = bus.memory.bios;
+
+  if(std::all_of(bios.begin(), bios.end(), [](u8 value) { return value == 0; })) {
+    for(auto [address, opcode] : kStubBIOS) {
+      write<u32>(bios.data(), address, opcode);
+    }
+  }
+
+  return read<u32>(bios.data(), 0) == kStubResetVector;
+}
+
+void BIOSHLE::SoftReset(arm::ARM7TDMI& cpu) {
+  auto& state = cpu.state;
+
+  const bool boot_from_ewram = bus.ReadByte(0x03007FFA, Bus::Nonsequential) != 0;
+
+  for(u32 address = 0x03007E00; address < 0x03008000; address += sizeof(u32)) {
+    bus.WriteWord(address, 0, Bus::Sequential);
+  }
+
+  cpu.SwitchMode(arm::MODE_SYS);
+
+  for(auto bank : {arm::BANK_SVC, arm::BANK_IRQ}) {
+    state.bank[bank][arm::BANK_R14] = 0;
+    state.spsr[bank].v = 0;
+  }
+  state.bank[arm::BANK_SVC][arm::BANK_R13] = 0x03007FE0;
+  state.bank[arm::BANK_IRQ][arm::BANK_R13] = 0x03007FA0;
+
+  for(int i = 0; i <= 12; i++) {
+    state.reg[i] = 0;
+  }
+  state.r13 = 0x03007F00;
+  state.r14 = 0;
+  state.cpsr.v = arm::MODE_SYS;
+  state.r15 = boot_from_ewram ? 0x02000000 : 0x08000000;
+}
+
+void BIOSHLE::RegisterRamReset(u32 flags) {
+  const auto clear = [this](u32 address, u32 size) {
+    for(u32 offset = 0; offset < size; offset += sizeof(u32)) {
+      bus.WriteWord(address + offset, 0, Bus::Sequential);
+    }
+  };
+
+  const auto clear_io = [this](u32 address_lo, u32 address_hi) {
+    for(u32 address = address_lo; address < address_hi; address += sizeof(u16)) {
+      bus.WriteHalf(address, 0, Bus::Nonsequential);
+    }
+  };
+
+  bus.WriteHalf(DISPCNT, 0x0080, Bus::Nonsequential);
+
+  if(flags & 0x01) clear(0x02000000, 0x40000);
+  if(flags & 0x02) clear(0x03000000, 0x7E00); // 0x03007E00 - 0x03007FFF is preserved
+  if(flags & 0x04) clear(0x05000000, 0x400);
+  if(flags & 0x08) clear(0x06000000, 0x18000);
+  if(flags & 0x10) clear(0x07000000, 0x400);
+
+  if(flags & 0x20) {
+    clear_io(SIODATA32_L, KEYINPUT);
+    bus.WriteHalf(RCNT, 0x8000, Bus::Nonsequential);
+  }
+
+  if(flags & 0x40) {
+    // The FIFOs are left alone, writing to them would push samples.
+    clear_io(SOUND1CNT_L, FIFO_A);
+  }
+
+  if(flags & 0x80) {
+    clear_io(GREENSWAP, SOUND1CNT_L);
+    clear_io(DMA0SAD, TM0CNT_L + 16);
+    bus.WriteHalf(KEYCNT, 0, Bus::Nonsequential);
+    bus.WriteHalf(IE, 0, Bus::Nonsequential);
+    bus.WriteHalf(WAITCNT, 0, Bus::Nonsequential);
+  }
+}
+
+void BIOSHLE::IntrWait(arm::ARM7TDMI& cpu, bool discard_old_flags, u16 wait_flags) {
+  if(discard_old_flags && !intr_wait_pending) {
+    const u16 flags = bus.ReadHalf(kBIOSIntrFlags, Bus::Nonsequential);
+    bus.WriteHalf(kBIOSIntrFlags, flags & ~wait_flags, Bus::Nonsequential);
+  }
+
+  bus.WriteHalf(IME, 1, Bus::Nonsequential);
+
+  const u16 flags = bus.ReadHalf(kBIOSIntrFlags, Bus::Nonsequential);
+
+  if(flags & wait_flags) {
+    bus.WriteHalf(kBIOSIntrFlags, flags & ~wait_flags, Bus::Nonsequential);
+    intr_wait_pending = false;
+    return;
+  }
+
+  /* Halt until the next IRQ and execute the SWI again once the IRQ handler returned.
+   * The IRQ handler preserves r0 and r1, so the SWI is re-executed with the same arguments.
+   */
+  intr_wait_pending = true;
+  bus.hw.haltcnt = Bus::Hardware::HaltControl::Halt;
+  bus.Step(1);
+  cpu.state.r15 -= cpu.state.cpsr.f.thumb ? sizeof(u16) : sizeof(u32);
+}
+
+void BIOSHLE::Div(arm::ARM7TDMI& cpu, s32 numerator, s32 denominator) {
+  auto& state = cpu.state;
+
+  if(denominator == 0) {
+    // The BIOS would loop infinitely (or return garbage), return something sane instead.
+    Log<Warn>("BIOS HLE: division by zero (numerator = 0x{:08X})", (u32)numerator);
+    state.r0 = numerator < 0 ? -1 : 1;
+    state.r1 = numerator;
+    state.r3 = 1;
+    return;
+  }
+
+  const s64 quotient = (s64)numerator / denominator;
+  const s64 remainder = (s64)numerator % denominator;
+
+  state.r0 = (u32)quotient;
+  state.r1 = (u32)remainder;
+  state.r3 = (u32)(quotient < 0 ? -quotient : quotient);
+
+  const int loops = BitLength((u32)std::abs((s64)numerator)) - BitLength((u32)std::abs((s64)denominator));
+
+  Idle(kDivLoopCycles * std::max(loops, 1));
+}
+
+void BIOSHLE::Sqrt(arm::ARM7TDMI& cpu) {
+  auto& state = cpu.state;
+
+  u32 value = state.r0;
+  u32 result = 0;
+  u32 bit = 1UL << 30;
+
+  while(bit > value) {
+    bit >>= 2;
+  }
+
+  while(bit != 0) {
+    if(value >= result + bit) {
+      value -= result + bit;
+      result = (result >> 1) + bit;
+    } else {
+      result >>= 1;
+    }
+    bit >>= 2;
+  }
+
+  state.r0 = result;
+
+  Idle(kSqrtLoopCycles * (BitLength(state.r0) + 1));
+}
+
+auto BIOSHLE::CalculateArcTan(s32 x, s32& r1, s32& r3) -> s32 {
+  const s32 a = -(Mul32(x, x) >> 14);
+  s32 b = (Mul32(0xA9, a) >> 14) + 0x390;
+
+  b = (Mul32(b, a) >> 14) + 0x91C;
+  b = (Mul32(b, a) >> 14) + 0xFB6;
+  b = (Mul32(b, a) >> 14) + 0x16AA;
+  b = (Mul32(b, a) >> 14) + 0x2081;
+  b = (Mul32(b, a) >> 14) + 0x3651;
+  b = (Mul32(b, a) >> 14) + 0xA2F9;
+
+  r1 = a;
+  r3 = b;
+
+  Idle(kArcTanCycles);
+
+  return Mul32(x, b) >> 16;
+}
+
+void BIOSHLE::ArcTan(arm::ARM7TDMI& cpu) {
+  auto& state = cpu.state;
+
+  s32 r1;
+  s32 r3;
+
+  state.r0 = (u32)CalculateArcTan((s32)state.r0, r1, r3);
+  state.r1 = (u32)r1;
+  state.r3 = (u32)r3;
+}
+
+void BIOSHLE::ArcTan2(arm::ARM7TDMI& cpu) {
+  auto& state = cpu.state;
+
+  const s32 x = (s32)state.r0;
+  const s32 y = (s32)state.r1;
+
+  s32 r1 = y;
+  s32 r3 = 0x170;
+  s32 angle;
+
+  const auto arctan = [&](s32 numerator, s32 denominator) {
+    return CalculateArcTan((s32)(((s64)numerator << 14) / denominator), r1, r3);
+  };
+
+  Idle(kArcTan2Cycles);
+
+  if(y == 0) {
+    angle = x >= 0 ? 0 : 0x8000;
+  } else if(x == 0) {
+    angle = y >= 0 ? 0x4000 : 0xC000;
+  } else if(y >= 0) {
+    if(x >= 0 && x >= y) {
+      angle = arctan(y, x);
+    } else if(x < 0 && -x >= y) {
+      angle = arctan(y, x) + 0x8000;
+    } else {
+      angle = 0x4000 - arctan(x, y);
+    }
+  } else {
+    if(x <= 0 && -x > -y) {
+      angle = arctan(y, x) + 0x8000;
+    } else if(x > 0 && x >= -y) {
+      angle = arctan(y, x) + 0x10000;
+    } else {
+      angle = 0xC000 - arctan(x, y);
+    }
+  }
+
+  state.r0 = (u32)angle & 0xFFFF;
+  state.r1 = (u32)r1;
+  state.r3 = (u32)r3;
+}
+
+void BIOSHLE::CpuSet(u32 src, u32 dst, u32 control) {
+  const u32 count = control & 0x1FFFFF;
+  const bool fill = control & (1 << 24);
+  const bool word = control & (1 << 26);
+
+  // The BIOS refuses to read from the BIOS area.
+  if((src & 0x0E000000) == 0) {
+    return;
+  }
+
+  int access = Bus::Nonsequential;
+
+  if(word) {
+    src &= ~3;
+    dst &= ~3;
+
+    u32 value = fill ? bus.ReadWord(src, access) : 0;
+
+    for(u32 i = 0; i < count; i++) {
+      if(!fill) {
+        value = bus.ReadWord(src, access);
+        src += sizeof(u32);
+      }
+      bus.WriteWord(dst, value, access);
+      dst += sizeof(u32);
+      access = Bus::Sequential;
+    }
+  } else {
+    src &= ~1;
+    dst &= ~1;
+
+    u16 value = fill ? bus.ReadHalf(src, access) : 0;
+
+    for(u32 i = 0; i < count; i++) {
+      if(!fill) {
+        value = bus.ReadHalf(src, access);
+        src += sizeof(u16);
+      }
+      bus.WriteHalf(dst, value, access);
+      dst += sizeof(u16);
+      access = Bus::Sequential;
+    }
+  }
+
+  Idle(kCpuSetUnitCycles * (int)count);
+}
+
+void BIOSHLE::CpuFastSet(u32 src, u32 dst, u32 control) {
+  // The BIOS always transfers blocks of eight words.
+  const u32 count = ((control & 0x1FFFFF) + 7) & ~7;
+  const bool fill = control & (1 << 24);
+
+  if((src & 0x0E000000) == 0) {
+    return;
+  }
+
+  src &= ~3;
+  dst &= ~3;
+
+  int access = Bus::Nonsequential;
+  u32 value = fill ? bus.ReadWord(src, access) : 0;
+
+  for(u32 i = 0; i < count; i++) {
+    if(!fill) {
+      value = bus.ReadWord(src, access);
+      src += sizeof(u32);
+    }
+    bus.WriteWord(dst, value, access);
+    dst += sizeof(u32);
+    access = Bus::Sequential;
+  }
+
+  Idle(kCpuFastSetBlockCycles * (int)(count / 8));
+}
+
+void BIOSHLE::LZ77UnComp(u32 src, u32 dst, bool vram) {
+  if((src & 0x0E000000) == 0 || LZ77UnCompNative(src, dst, vram)) {
+    return;
+  }
+
+  const u32 size = bus.ReadWord(src, Bus::Nonsequential) >> 8;
+
+  std::array<u8, 0x1000> window;
+  u32 written = 0;
+  u16 halfword = 0;
+
+  src += sizeof(u32);
+
+  /* The VRAM variant buffers two bytes and writes them as a halfword, because VRAM does not support 8-bit writes.
+   * Back-references are served from a window of the last 4 KiB of output rather than from the destination.
+   */
+  const auto output = [&](u8 value) {
+    window[written & 0xFFF] = value;
+
+    if(vram) {
+      halfword |= value << ((written & 1) << 3);
+      if(written & 1) {
+        bus.WriteHalf(dst + written - 1, halfword, Bus::Nonsequential);
+        halfword = 0;
+      }
+    } else {
+      bus.WriteByte(dst + written, value, Bus::Nonsequential);
+    }
+
+    written++;
+  };
+
+  while(written < size) {
+    u8 flags = bus.ReadByte(src++, Bus::Nonsequential);
+
+    for(int i = 0; i < 8 && written < size; i++) {
+      if(flags & 0x80) {
+        const u8 byte0 = bus.ReadByte(src++, Bus::Nonsequential);
+        const u8 byte1 = bus.ReadByte(src++, Bus::Nonsequential);
+        const u32 length = (byte0 >> 4) + 3;
+        const u32 distance = (((byte0 & 0xF) << 8) | byte1) + 1;
+
+        for(u32 j = 0; j < length && written < size; j++) {
+          // Like the BIOS, a reference in front of the output reads whatever precedes the destination.
+          if(distance > written) {
+            output(bus.ReadByte(dst + written - distance, Bus::Nonsequential));
+          } else {
+            output(window[(written - distance) & 0xFFF]);
+          }
+        }
+      } else {
+        output(bus.ReadByte(src++, Bus::Nonsequential));
+      }
+
+      flags <<= 1;
+    }
+  }
+
+  Idle(kUnCompByteCycles * (int)size);
+}
+
+void BIOSHLE::HuffUnComp(u32 src, u32 dst) {
+  if((src & 0x0E000000) == 0 || HuffUnCompNative(src, dst)) {
+    return;
+  }
+
+  const u32 header = bus.ReadWord(src, Bus::Nonsequential);
+  const u32 size = header >> 8;
+  const int data_bits = header & 15;
+
+  if(data_bits != 4 && data_bits != 8) {
+    Log<Warn>("BIOS HLE: unsupported Huffman data size: {} bits", data_bits);
+    return;
+  }
+
+  const u32 tree_root = src + 5;
+  const u8 root_node = bus.ReadByte(tree_root, Bus::Nonsequential);
+
+  u32 bitstream = src + 4 + (bus.ReadByte(src + 4, Bus::Nonsequential) + 1) * 2;
+  u32 node_address = tree_root;
+  u8 node = root_node;
+  u32 word = 0;
+  int word_bits = 0;
+  u32 written = 0;
+
+  while(written < size) {
+    u32 bits = bus.ReadWord(bitstream, Bus::Nonsequential);
+
+    bitstream += sizeof(u32);
+
+    for(int i = 0; i < 32 && written < size; i++) {
+      const int bit = bits >> 31;
+      const u32 child_address = (node_address & ~1) + (node & 0x3F) * 2 + 2 + bit;
+
+      bits <<= 1;
+
+      if(node & (0x80 >> bit)) {
+        word |= (bus.ReadByte(child_address, Bus::Nonsequential) & ((1 << data_bits) - 1)) << word_bits;
+        word_bits += data_bits;
+
+        if(word_bits == 32) {
+          bus.WriteWord(dst + written, word, Bus::Nonsequential);
+          written += sizeof(u32);
+          word = 0;
+          word_bits = 0;
+        }
+
+        node_address = tree_root;
+        node = root_node;
+      } else {
+        node_address = child_address;
+        node = bus.ReadByte(child_address, Bus::Nonsequential);
+      }
+    }
+  }
+
+  Idle(kUnCompByteCycles * (int)size);
+}
+
+void BIOSHLE::RLUnComp(u32 src, u32 dst, bool vram) {
+  if((src & 0x0E000000) == 0 || RLUnCompNative(src, dst, vram)) {
+    return;
+  }
+
+  const u32 size = bus.ReadWord(src, Bus::Nonsequential) >> 8;
+
+  u32 written = 0;
+  u16 halfword = 0;
+
+  src += sizeof(u32);
+
+  const auto output = [&](u8 value) {
+    if(vram) {
+      halfword |= value << ((written & 1) << 3);
+      if(written & 1) {
+        bus.WriteHalf(dst + written - 1, halfword, Bus::Nonsequential);
+        halfword = 0;
+      }
+    } else {
+      bus.WriteByte(dst + written, value, Bus::Nonsequential);
+    }
+
+    written++;
+  };
+
+  while(written < size) {
+    const u8 flags = bus.ReadByte(src++, Bus::Nonsequential);
+
+    if(flags & 0x80) {
+      const u32 length = (flags & 0x7F) + 3;
+      const u8 value = bus.ReadByte(src++, Bus::Nonsequential);
+
+      for(u32 i = 0; i < length && written < size; i++) {
+        output(value);
+      }
+    } else {
+      const u32 length = (flags & 0x7F) + 1;
+
+      for(u32 i = 0; i < length && written < size; i++) {
+        output(bus.ReadByte(src++, Bus::Nonsequential));
+      }
+    }
+  }
+
+  Idle(kUnCompByteCycles * (int)size);
+}
+
+/**
+ * Fast path for the decompression SWIs: the data is decoded from a host pointer into a buffer,
+ * which then is copied to WRAM or VRAM in one go. The cycles of all memory accesses are summed up
+ * from the wait state tables and charged at once (ignoring VRAM contention).
+ * Returns false without side effects if the source or destination is not plain memory, in which case
+ * the caller falls back to decompressing through the bus.
+ */
+bool BIOSHLE::OpenUnCompSource(u32 src, HostStream& stream) {
+  u32 offset = src & 0x00FF'FFFF;
+
+  switch(src >> 24) {
+    case 0x02: stream = {bus.memory.wram.data(), (u32)bus.memory.wram.size()}; break;
+    case 0x03: stream = {bus.memory.iram.data(), (u32)bus.memory.iram.size()}; break;
+    // 0x0D is excluded because it may be mapped to the EEPROM.
+    case 0x08:
+    case 0x09:
+    case 0x0A:
+    case 0x0B:
+    case 0x0C: {
+      auto& rom = bus.memory.rom.GetRawROM();
+
+      offset = src & 0x01FF'FFFF;
+      stream = {rom.data(), (u32)rom.size()};
+      break;
+    }
+    default: return false;
+  }
+
+  if(offset >= stream.size) {
+    return false;
+  }
+
+  stream.data += offset;
+  stream.size -= offset;
+  return true;
+}
+
+bool BIOSHLE::CommitUnComp(u32 src, u32 src_length, u32 dst, u32 dst_length, int unit) {
+  const int src_page = src >> 24;
+  const int dst_page = dst >> 24;
+
+  u8* host = nullptr;
+
+  if(dst_page == 0x06) {
+    const u32 offset = dst & 0x00FF'FFFF;
+
+    // VRAM cannot be written with 8-bit accesses.
+    if(unit != sizeof(u8) && offset + dst_length <= 0x18000) {
+      host = bus.hw.ppu.GetVRAM() + offset;
+    }
+  } else if(dst_page == 0x02 || dst_page == 0x03) {
+    host = bus.GetHostAddress(dst, dst_length);
+  }
+
+  if(host == nullptr || (src_page == dst_page && src < dst + dst_length && dst < src + src_length)) {
+    return false;
+  }
+
+  if(bus.hw.dma.IsRunning()) {
+    bus.hw.dma.Run();
+  }
+
+  if(dst_page == 0x06) {
+    bus.hw.ppu.Sync();
+  }
+
+  if(src_page >= 0x08) {
+    bus.StopPrefetch();
+  }
+
+  std::memcpy(host, uncomp_buffer.data(), dst_length);
+  bus.MarkDirty(dst, dst_length);
+
+  const int dst_wait = unit == sizeof(u32) ? bus.wait32[0][dst_page] : bus.wait16[0][dst_page];
+
+  bus.Step((int)src_length * bus.wait16[0][src_page] + (int)(dst_length / unit) * dst_wait);
+  return true;
+}
+
+bool BIOSHLE::LZ77UnCompNative(u32 src, u32 dst, bool vram) {
+  HostStream stream;
+
+  if(!OpenUnCompSource(src, stream)) {
+    return false;
+  }
+
+  const u32 size = stream.ReadWord() >> 8;
+
+  uncomp_buffer.resize(size);
+
+  u32 written = 0;
+
+  while(written < size && !stream.overrun) {
+    u8 flags = stream.ReadByte();
+
+    for(int i = 0; i < 8 && written < size; i++) {
+      if(flags & 0x80) {
+        const u8 byte0 = stream.ReadByte();
+        const u8 byte1 = stream.ReadByte();
+        const u32 length = (byte0 >> 4) + 3;
+        const u32 distance = (((byte0 & 0xF) << 8) | byte1) + 1;
+
+        // The reference reaches in front of the destination buffer.
+        if(distance > written) {
+          return false;
+        }
+
+        for(u32 j = 0; j < length && written < size; j++) {
+          uncomp_buffer[written] = uncomp_buffer[written - distance];
+          written++;
+        }
+      } else {
+        uncomp_buffer[written++] = stream.ReadByte();
+      }
+
+      flags <<= 1;
+    }
+  }
+
+  if(stream.overrun) {
+    return false;
+  }
+
+  const int unit = vram ? sizeof(u16) : sizeof(u8);
+
+  if(!CommitUnComp(src, stream.position, dst, size & ~(unit - 1), unit)) {
+    return false;
+  }
+
+  Idle(kUnCompByteCycles * (int)size);
+  return true;
+}
+
+bool BIOSHLE::HuffUnCompNative(u32 src, u32 dst) {
+  HostStream stream;
+
+  if(!OpenUnCompSource(src, stream)) {
+    return false;
+  }
+
+  const u32 header = stream.ReadWord();
+  const u32 size = header >> 8;
+  const int data_bits = header & 15;
+
+  if(data_bits != 4 && data_bits != 8) {
+    return false;
+  }
+
+  // The BIOS writes whole words.
+  const u32 length = (size + 3) & ~3;
+
+  uncomp_buffer.resize(length);
+
+  const u32 tree_root = 5;
+  const u8 root_node = stream.ReadByte(tree_root);
+
+  u32 node_offset = tree_root;
+  u8 node = root_node;
+  u32 word = 0;
+  int word_bits = 0;
+  u32 written = 0;
+
+  stream.position = 4 + (stream.ReadByte(4) + 1) * 2;
+
+  while(written < size && !stream.overrun) {
+    u32 bits = stream.ReadWord();
+
+    for(int i = 0; i < 32 && written < size; i++) {
+      const int bit = bits >> 31;
+      const u32 child_offset = (node_offset & ~1) + (node & 0x3F) * 2 + 2 + bit;
+
+      bits <<= 1;
+
+      if(node & (0x80 >> bit)) {
+        word |= (stream.ReadByte(child_offset) & ((1 << data_bits) - 1)) << word_bits;
+        word_bits += data_bits;
+
+        if(word_bits == 32) {
+          write<u32>(uncomp_buffer.data(), written, word);
+          written += sizeof(u32);
+          word = 0;
+          word_bits = 0;
+        }
+
+        node_offset = tree_root;
+        node = root_node;
+      } else {
+        node_offset = child_offset;
+        node = stream.ReadByte(child_offset);
+      }
+    }
+  }
+
+  // The tree is read randomly, so the whole stream is treated as the source range.
+  if(stream.overrun || !CommitUnComp(src, stream.position, dst, length, sizeof(u32))) {
+    return false;
+  }
+
+  Idle(kUnCompByteCycles * (int)size);
+  return true;
+}
+
+bool BIOSHLE::RLUnCompNative(u32 src, u32 dst, bool vram) {
+  HostStream stream;
+
+  if(!OpenUnCompSource(src, stream)) {
+    return false;
+  }
+
+  const u32 size = stream.ReadWord() >> 8;
+
+  uncomp_buffer.resize(size);
+
+  u32 written = 0;
+
+  while(written < size && !stream.overrun) {
+    const u8 flags = stream.ReadByte();
+
+    if(flags & 0x80) {
+      const u32 length = std::min((flags & 0x7F) + 3U, size - written);
+
+      std::memset(&uncomp_buffer[written], stream.ReadByte(), length);
+      written += length;
+    } else {
+      const u32 length = (flags & 0x7F) + 1;
+
+      for(u32 i = 0; i < length && written < size; i++) {
+        uncomp_buffer[written++] = stream.ReadByte();
+      }
+    }
+  }
+
+  if(stream.overrun) {
+    return false;
+  }
+
+  const int unit = vram ? sizeof(u16) : sizeof(u8);
+
+  if(!CommitUnComp(src, stream.position, dst, size & ~(unit - 1), unit)) {
+    return false;
+  }
+
+  Idle(kUnCompByteCycles * (int)size);
+  return true;
+}
+
+void BIOSHLE::Idle(int cycles) {
+  bus.Step(cycles);
+}
+
+void BIOSHLE::LoadState(SaveState const& state) {
+  intr_wait_pending = state.hle.bios_intr_wait_pending;
+}
+
+void BIOSHLE::CopyState(SaveState& state) {
+  state.hle.bios_intr_wait_pending = intr_wait_pending;
+}
+
+} // namespace nba::core
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2024 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#pragma once
+
+#include <nba/integer.hpp>
+#include <nba/save_state.hpp>
+#include <vector>
+
+namespace nba::core {
+
+namespace arm {
+struct ARM7TDMI;
+} // namespace nba::core::arm
+
+struct Bus;
+struct HostStream;
+
+/**
+ * High-level emulation of the hot BIOS software interrupts.
+ * Supported SWIs are executed natively instead of entering the BIOS SWI vector.
+ * Memory is generally accessed through the bus, so that wait states and DMA are handled like for the real BIOS.
+ * Decompression into WRAM or VRAM instead is done natively with a single bulk write, when possible.
+ * The cost of the code that would have run in the BIOS is approximated and charged on top.
+ */
+struct BIOSHLE {
+  BIOSHLE(Bus& bus) : bus(bus) {}
+
+  void Reset();
+
+  /**
+   * Called in place of the SWI exception. On entry r15 holds the address of the instruction following the SWI.
+   * Returns false if the SWI must be handled by the BIOS. Otherwise the CPU continues at r15 after a pipeline refill.
+   */
+  bool HandleSWI(arm::ARM7TDMI& cpu, u8 number);
+
+  // Installs a minimal BIOS (reset, SWI and IRQ vectors only) if no BIOS image was attached.
+  bool InstallStubBIOS();
+
+  void LoadState(SaveState const& state);
+  void CopyState(SaveState& state);
+
+private:
+  void SoftReset(arm::ARM7TDMI& cpu);
+  void RegisterRamReset(u32 flags);
+  void IntrWait(arm::ARM7TDMI& cpu, bool discard_old_flags, u16 wait_flags);
+  void Div(arm::ARM7TDMI& cpu, s32 numerator, s32 denominator);
+  void Sqrt(arm::ARM7TDMI& cpu);
+  void ArcTan(arm::ARM7TDMI& cpu);
+  void ArcTan2(arm::ARM7TDMI& cpu);
+  void CpuSet(u32 src, u32 dst, u32 control);
+  void CpuFastSet(u32 src, u32 dst, u32 control);
+  void LZ77UnComp(u32 src, u32 dst, bool vram);
+  void HuffUnComp(u32 src, u32 dst);
+  void RLUnComp(u32 src, u32 dst, bool vram);
+
+  bool OpenUnCompSource(u32 src, HostStream& stream);
+  bool CommitUnComp(u32 src, u32 src_length, u32 dst, u32 dst_length, int unit);
+  bool LZ77UnCompNative(u32 src, u32 dst, bool vram);
+  bool HuffUnCompNative(u32 src, u32 dst);
+  bool RLUnCompNative(u32 src, u32 dst, bool vram);
+
+  auto CalculateArcTan(s32 x, s32& r1, s32& r3) -> s32;
+
+  void Idle(int cycles);
+
+  Bus& bus;
+
+  // Set while IntrWait waits for an IRQ, so that the re-executed SWI does not discard the flags again.
+  bool intr_wait_pending = false;
+
+  std::vector<u8> uncomp_buffer;
+};
+
+} // namespace nba::core
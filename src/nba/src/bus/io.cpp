@@ -5,7 +5,9 @@
  * Refer to the included LICENSE file.
  */
 
+#include <array>
 #include <cstdio>
+#include <nba/common/compiler.hpp>
 
 #include "arm/arm7tdmi.hpp"
 #include "bus/bus.hpp"
@@ -13,6 +15,240 @@
 
 namespace nba::core {
 
+/**
+ * 16-bit and 32-bit accesses to the first 1 KiB of the IO page are dispatched through tables,
+ * which are generated at compile time and indexed by the register offset.
+ * Registers which games typically poll or write in hot loops have native handlers,
+ * all other registers fall back to the byte-wise access handlers.
+ */
+using IOReadHalfHandler = u16 (*)(Bus::Hardware& hw, u32 address);
+using IOReadWordHandler = u32 (*)(Bus::Hardware& hw, u32 address);
+using IOWriteHalfHandler = void (*)(Bus::Hardware& hw, u32 address, u16 value);
+using IOWriteWordHandler = void (*)(Bus::Hardware& hw, u32 address, u32 value);
+
+static constexpr u32 g_io_table_limit = 0x04000400;
+
+static constexpr auto g_io_read_half = []() constexpr {
+  std::array<IOReadHalfHandler, 0x200> table{};
+
+  for(auto& handler : table) {
+    handler = [](Bus::Hardware& hw, u32 address) -> u16 {
+      return hw.ReadByte(address) | (hw.ReadByte(address + 1) << 8);
+    };
+  }
+
+  const auto set = [&](u32 address, IOReadHalfHandler handler) {
+    table[(address & 0x3FF) >> 1] = handler;
+  };
+
+  // PPU
+  set(DISPCNT, [](Bus::Hardware& hw, u32 /*address*/) -> u16 { return hw.ppu.mmio.dispcnt.ReadHalf(); });
+  set(DISPSTAT, [](Bus::Hardware& hw, u32 /*address*/) -> u16 { return hw.ppu.mmio.dispstat.ReadHalf(); });
+  set(VCOUNT, [](Bus::Hardware& hw, u32 /*address*/) -> u16 { return hw.ppu.mmio.vcount; });
+
+  for(u32 address = BG0CNT; address <= BG3CNT; address += sizeof(u16)) {
+    set(address, [](Bus::Hardware& hw, u32 address) -> u16 {
+      return hw.ppu.mmio.bgcnt[(address - BG0CNT) >> 1].ReadHalf();
+    });
+  }
+
+  set(WININ, [](Bus::Hardware& hw, u32 /*address*/) -> u16 { return hw.ppu.mmio.winin.ReadHalf(); });
+  set(WINOUT, [](Bus::Hardware& hw, u32 /*address*/) -> u16 { return hw.ppu.mmio.winout.ReadHalf(); });
+  set(BLDCNT, [](Bus::Hardware& hw, u32 /*address*/) -> u16 { return hw.ppu.mmio.bldcnt.ReadHalf(); });
+
+  // DMA 0 - 3
+  for(u32 address = DMA0CNT_H; address <= DMA3CNT_H; address += 12) {
+    set(address, [](Bus::Hardware& hw, u32 address) -> u16 {
+      const int chan_id = (address - DMA0CNT_H) / 12;
+
+      return hw.dma.Read(chan_id, 10) | (hw.dma.Read(chan_id, 11) << 8);
+    });
+  }
+
+  // Timer 0 - 3
+  for(u32 address = TM0CNT_L; address <= TM3CNT_H; address += sizeof(u16)) {
+    set(address, [](Bus::Hardware& hw, u32 address) -> u16 {
+      return hw.timer.ReadHalf((address >> 2) & 3, address & 2);
+    });
+  }
+
+  // Keypad
+  set(KEYINPUT, [](Bus::Hardware& hw, u32 /*address*/) -> u16 {
+    return hw.keypad.input.ReadByte(0) | (hw.keypad.input.ReadByte(1) << 8);
+  });
+
+  // IRQ controller
+  set(IE,  [](Bus::Hardware& hw, u32 /*address*/) -> u16 { return hw.irq.ReadHalf(0); });
+  set(IF,  [](Bus::Hardware& hw, u32 /*address*/) -> u16 { return hw.irq.ReadHalf(2); });
+  set(IME, [](Bus::Hardware& hw, u32 /*address*/) -> u16 { return hw.irq.ReadHalf(4); });
+
+  return table;
+}();
+
+static constexpr auto g_io_read_word = []() constexpr {
+  std::array<IOReadWordHandler, 0x100> table{};
+
+  for(auto& handler : table) {
+    handler = [](Bus::Hardware& hw, u32 address) -> u32 {
+      return hw.ReadHalf(address) | (hw.ReadHalf(address + 2) << 16);
+    };
+  }
+
+  // Timer 0 - 3
+  for(u32 address = TM0CNT_L; address <= TM3CNT_L; address += sizeof(u32)) {
+    table[(address & 0x3FF) >> 2] = [](Bus::Hardware& hw, u32 address) -> u32 {
+      return hw.timer.ReadWord((address >> 2) & 3);
+    };
+  }
+
+  return table;
+}();
+
+static constexpr auto g_io_write_half = []() constexpr {
+  std::array<IOWriteHalfHandler, 0x200> table{};
+
+  for(auto& handler : table) {
+    handler = [](Bus::Hardware& hw, u32 address, u16 value) {
+      hw.WriteByte(address + 0, u8(value >> 0));
+      hw.WriteByte(address + 1, u8(value >> 8));
+    };
+  }
+
+  const auto set = [&](u32 address, IOWriteHalfHandler handler) {
+    table[(address & 0x3FF) >> 1] = handler;
+  };
+
+  // PPU
+  set(DISPCNT, [](Bus::Hardware& hw, u32 /*address*/, u16 value) { hw.ppu.mmio.dispcnt.WriteHalf(value); });
+  set(DISPSTAT, [](Bus::Hardware& hw, u32 /*address*/, u16 value) { hw.ppu.mmio.dispstat.WriteHalf(value); });
+
+  for(u32 address = BG0CNT; address <= BG3CNT; address += sizeof(u16)) {
+    set(address, [](Bus::Hardware& hw, u32 address, u16 value) {
+      hw.ppu.mmio.bgcnt[(address - BG0CNT) >> 1].WriteHalf(value);
+    });
+  }
+
+  for(u32 address = BG0HOFS; address <= BG3VOFS; address += sizeof(u16)) {
+    set(address, [](Bus::Hardware& hw, u32 address, u16 value) {
+      auto& ppu_io = hw.ppu.mmio;
+      const int id = (address - BG0HOFS) >> 2;
+
+      if(address & 2) {
+        ppu_io.bgvofs[id] = value & 0x1FF;
+      } else {
+        ppu_io.bghofs[id] = value & 0x1FF;
+      }
+    });
+  }
+
+  set(WIN0H, [](Bus::Hardware& hw, u32 /*address*/, u16 value) { hw.ppu.mmio.winh[0].WriteHalf(value); });
+  set(WIN1H, [](Bus::Hardware& hw, u32 /*address*/, u16 value) { hw.ppu.mmio.winh[1].WriteHalf(value); });
+  set(WIN0V, [](Bus::Hardware& hw, u32 /*address*/, u16 value) { hw.ppu.mmio.winv[0].WriteHalf(value); });
+  set(WIN1V, [](Bus::Hardware& hw, u32 /*address*/, u16 value) { hw.ppu.mmio.winv[1].WriteHalf(value); });
+  set(WININ, [](Bus::Hardware& hw, u32 /*address*/, u16 value) { hw.ppu.mmio.winin.WriteHalf(value); });
+  set(WINOUT, [](Bus::Hardware& hw, u32 /*address*/, u16 value) { hw.ppu.mmio.winout.WriteHalf(value); });
+  set(BLDCNT, [](Bus::Hardware& hw, u32 /*address*/, u16 value) { hw.ppu.mmio.bldcnt.WriteHalf(value); });
+
+  // DMA 0 - 3
+  for(u32 address = DMA0CNT_H; address <= DMA3CNT_H; address += 12) {
+    set(address, [](Bus::Hardware& hw, u32 address, u16 value) {
+      const int chan_id = (address - DMA0CNT_H) / 12;
+
+      hw.dma.Write(chan_id, 10, u8(value >> 0));
+      hw.dma.Write(chan_id, 11, u8(value >> 8));
+    });
+  }
+
+  // Sound
+  for(u32 address = FIFO_A; address <= FIFO_B + 2; address += sizeof(u16)) {
+    set(address, [](Bus::Hardware& hw, u32 address, u16 value) {
+      auto& apu_io = hw.apu.mmio;
+
+      if(apu_io.soundcnt.master_enable) {
+        hw.timer.SyncFIFOTimers();
+        apu_io.fifo[(address >> 2) & 1].WriteHalf(address & 2, value);
+        hw.timer.RescheduleFIFOTimers();
+      }
+    });
+  }
+
+  // Timer 0 - 3
+  for(u32 address = TM0CNT_L; address <= TM3CNT_H; address += sizeof(u16)) {
+    set(address, [](Bus::Hardware& hw, u32 address, u16 value) {
+      hw.timer.WriteHalf((address >> 2) & 3, address & 2, value);
+    });
+  }
+
+  // Serial communication
+  set(SIOCNT, [](Bus::Hardware& hw, u32 /*address*/, u16 value) {
+    auto& siocnt = hw.siocnt;
+
+    siocnt = (siocnt & 0x80u) | (value & ~0x80u);
+
+    if(!(siocnt & 0x80u) && value & 0x80u) {
+      // bit 0 (from bit  1): internal shift clock (0 = 256 KHz, 1 = 2 MHz)
+      // bit 1 (from bit 12): transfer length (0 = 8-bit, 1 = 32-bit)
+      static const int table[4] {
+        512,
+        64,
+        2048,
+        256
+      };
+
+      siocnt |= 0x80u;
+
+      const int cycles = table[((siocnt >> 1) & 1u) | ((siocnt >> 11) & 2u)];
+
+      hw.bus->scheduler.Add(cycles, Scheduler::EventClass::SIO_transfer_done);
+    }
+  });
+
+  /* Do not invoke Keypad::UpdateIRQ() twice for a single 16-bit write.
+   * See https://github.com/fleroviux/NanoBoyAdvance/issues/152 for details.
+   */
+  set(KEYCNT, [](Bus::Hardware& hw, u32 /*address*/, u16 value) { hw.keypad.control.WriteHalf(value); });
+
+  // IRQ controller
+  set(IE,  [](Bus::Hardware& hw, u32 /*address*/, u16 value) { hw.irq.WriteHalf(0, value); });
+  set(IF,  [](Bus::Hardware& hw, u32 /*address*/, u16 value) { hw.irq.WriteHalf(2, value); });
+  set(IME, [](Bus::Hardware& hw, u32 /*address*/, u16 value) { hw.irq.WriteByte(4, value); });
+
+  return table;
+}();
+
+static constexpr auto g_io_write_word = []() constexpr {
+  std::array<IOWriteWordHandler, 0x100> table{};
+
+  for(auto& handler : table) {
+    handler = [](Bus::Hardware& hw, u32 address, u32 value) {
+      hw.WriteHalf(address + 0, u16(value >> 0));
+      hw.WriteHalf(address + 2, u16(value >> 16));
+    };
+  }
+
+  // Sound
+  for(u32 address = FIFO_A; address <= FIFO_B; address += sizeof(u32)) {
+    table[(address & 0x3FF) >> 2] = [](Bus::Hardware& hw, u32 address, u32 value) {
+      auto& apu_io = hw.apu.mmio;
+
+      if(apu_io.soundcnt.master_enable) {
+        hw.timer.SyncFIFOTimers();
+        apu_io.fifo[(address >> 2) & 1].WriteWord(value);
+        hw.timer.RescheduleFIFOTimers();
+      }
+    };
+  }
+
+  // Timer 0 - 3
+  for(u32 address = TM0CNT_L; address <= TM3CNT_L; address += sizeof(u32)) {
+    table[(address & 0x3FF) >> 2] = [](Bus::Hardware& hw, u32 address, u32 value) {
+      hw.timer.WriteWord((address >> 2) & 3, value);
+    };
+  }
+
+  return table;
+}();
+
 auto Bus::Hardware::ReadByte(u32 address) ->  u8 {
   auto& apu_io = apu.mmio;
   auto& ppu_io = ppu.mmio;
@@ -203,32 +439,16 @@ auto Bus::Hardware::ReadByte(u32 address) ->  u8 {
 }
 
 auto Bus::Hardware::ReadHalf(u32 address) -> u16 {
-  switch(address) {
-    // Timer 0 - 3
-    case TM0CNT_L: return timer.ReadHalf(0, 0);
-    case TM0CNT_H: return timer.ReadHalf(0, 2);
-    case TM1CNT_L: return timer.ReadHalf(1, 0);
-    case TM1CNT_H: return timer.ReadHalf(1, 2);
-    case TM2CNT_L: return timer.ReadHalf(2, 0);
-    case TM2CNT_H: return timer.ReadHalf(2, 2);
-    case TM3CNT_L: return timer.ReadHalf(3, 0);
-    case TM3CNT_H: return timer.ReadHalf(3, 2);
-
-    // IRQ controller
-    case IE:  return irq.ReadHalf(0);
-    case IF:  return irq.ReadHalf(2);
-    case IME: return irq.ReadHalf(4);
+  if(likely(address < g_io_table_limit)) {
+    return g_io_read_half[(address & 0x3FF) >> 1](*this, address);
   }
 
   return ReadByte(address) | (ReadByte(address + 1) << 8);
 }
 
 auto Bus::Hardware::ReadWord(u32 address) -> u32 {
-  switch(address) {
-    case TM0CNT_L: return timer.ReadWord(0);
-    case TM1CNT_L: return timer.ReadWord(1);
-    case TM2CNT_L: return timer.ReadWord(2);
-    case TM3CNT_L: return timer.ReadWord(3);
+  if(likely(address < g_io_table_limit)) {
+    return g_io_read_word[(address & 0x3FF) >> 2](*this, address);
   }
 
   return ReadHalf(address) | (ReadHalf(address + 2) << 16);
@@ -478,19 +698,32 @@ void Bus::Hardware::WriteByte(u32 address,  u8 value) {
       apu_io.psg3.WriteSample(address & 0xF, value);
       break;
     }
-    case FIFO_A:   if(apu_enable) apu_io.fifo[0].WriteByte(0, value); break;
-    case FIFO_A+1: if(apu_enable) apu_io.fifo[0].WriteByte(1, value); break;
-    case FIFO_A+2: if(apu_enable) apu_io.fifo[0].WriteByte(2, value); break;
-    case FIFO_A+3: if(apu_enable) apu_io.fifo[0].WriteByte(3, value); break;
-    case FIFO_B:   if(apu_enable) apu_io.fifo[1].WriteByte(0, value); break;
-    case FIFO_B+1: if(apu_enable) apu_io.fifo[1].WriteByte(1, value); break;
-    case FIFO_B+2: if(apu_enable) apu_io.fifo[1].WriteByte(2, value); break;
-    case FIFO_B+3: if(apu_enable) apu_io.fifo[1].WriteByte(3, value); break;
+    case FIFO_A:
+    case FIFO_A+1:
+    case FIFO_A+2:
+    case FIFO_A+3:
+    case FIFO_B:
+    case FIFO_B+1:
+    case FIFO_B+2:
+    case FIFO_B+3: {
+      if(apu_enable) {
+        // Coalesced overflows of the FIFO timers must see the FIFO as it was before this write.
+        timer.SyncFIFOTimers();
+        apu_io.fifo[(address >> 2) & 1].WriteByte(address & 3, value);
+        timer.RescheduleFIFOTimers();
+      }
+      break;
+    }
     case SOUNDCNT_L:   if(apu_enable) apu_io.soundcnt.Write(0, value); break;
     case SOUNDCNT_L+1: if(apu_enable) apu_io.soundcnt.Write(1, value); break;
-    case SOUNDCNT_H:   apu_io.soundcnt.Write(2, value); break;
-    case SOUNDCNT_H+1: apu_io.soundcnt.Write(3, value); break;
-    case SOUNDCNT_X:   apu_io.soundcnt.Write(4, value); break;
+    case SOUNDCNT_H:
+    case SOUNDCNT_H+1:
+    case SOUNDCNT_X: {
+      timer.SyncFIFOTimers();
+      apu_io.soundcnt.Write(address - SOUNDCNT_L, value);
+      timer.RescheduleFIFOTimers();
+      break;
+    }
     case SOUNDBIAS:    apu_io.bias.Write(0, value); break;
     case SOUNDBIAS+1:  apu_io.bias.Write(1, value); break;
 
@@ -537,6 +770,8 @@ void Bus::Hardware::WriteByte(u32 address,  u8 value) {
     }
     case WAITCNT+1: {
       const bool prefetch_old = waitcnt.prefetch;
+      // Opcodes fetched up to now have been fetched with the old setting.
+      bus->SyncPrefetch();
       waitcnt.ws2[0] = (value >> 0) & 3;
       waitcnt.ws2[1] = (value >> 2) & 1;
       waitcnt.phi = (value >> 3) & 3;
@@ -575,66 +810,15 @@ void Bus::Hardware::WriteByte(u32 address,  u8 value) {
 }
 
 void Bus::Hardware::WriteHalf(u32 address, u16 value) {
-  auto& apu_io = apu.mmio;
-
-  const bool apu_enable = apu_io.soundcnt.master_enable;
+  if(likely(address < g_io_table_limit)) {
+    g_io_write_half[(address & 0x3FF) >> 1](*this, address, value);
+    return;
+  }
 
   switch(address) {
-    case FIFO_A+0: if(apu_enable) apu_io.fifo[0].WriteHalf(0, value); break;
-    case FIFO_A+2: if(apu_enable) apu_io.fifo[0].WriteHalf(2, value); break;
-    case FIFO_B+0: if(apu_enable) apu_io.fifo[1].WriteHalf(0, value); break;
-    case FIFO_B+2: if(apu_enable) apu_io.fifo[1].WriteHalf(2, value); break;
-
-    // Timers 0 - 3
-    case TM0CNT_L: timer.WriteHalf(0, 0, value); break;
-    case TM0CNT_H: timer.WriteHalf(0, 2, value); break;
-    case TM1CNT_L: timer.WriteHalf(1, 0, value); break;
-    case TM1CNT_H: timer.WriteHalf(1, 2, value); break;
-    case TM2CNT_L: timer.WriteHalf(2, 0, value); break;
-    case TM2CNT_H: timer.WriteHalf(2, 2, value); break;
-    case TM3CNT_L: timer.WriteHalf(3, 0, value); break;
-    case TM3CNT_H: timer.WriteHalf(3, 2, value); break;
-
-    /* Do not invoke Keypad::UpdateIRQ() twice for a single 16-bit write.
-     * See https://github.com/fleroviux/NanoBoyAdvance/issues/152 for details.
-     */
-    case KEYCNT: {
-      keypad.control.WriteHalf(value);
-      break;
-    }
-
-    // IRQ controller
-    case IE:  irq.WriteHalf(0, value); break;
-    case IF:  irq.WriteHalf(2, value); break;
-    case IME: irq.WriteByte(4, value); break;
-
-    case SIOCNT: {
-      siocnt = (siocnt & 0x80u) | (value & ~0x80u);
-
-      if(!(siocnt & 0x80u) && value & 0x80u) {
-        // bit 0 (from bit  1): internal shift clock (0 = 256 KHz, 1 = 2 MHz)
-        // bit 1 (from bit 12): transfer length (0 = 8-bit, 1 = 32-bit)
-        static const int table[4] {
-          512,
-          64,
-          2048,
-          256
-        };
-
-        siocnt |= 0x80u;
-
-        const int cycles = table[((siocnt >> 1) & 1u) | ((siocnt >> 11) & 2u)];
-
-        bus->scheduler.Add(cycles, Scheduler::EventClass::SIO_transfer_done);
-      }
-
-      break;
-    }
-
     case MGBA_LOG_SEND: {
       if(mgba_log.enable && (value & 0x100) != 0) {
-        fmt::print("mGBA log: {}\n", mgba_log.message.data());
-        std::fflush(stdout);
+        LogUnlimited<Info>("mGBA log: {}", mgba_log.message.data());
         mgba_log.message.fill(0);
       }
       break;
@@ -655,26 +839,13 @@ void Bus::Hardware::WriteHalf(u32 address, u16 value) {
 }
 
 void Bus::Hardware::WriteWord(u32 address, u32 value) {
-  auto& apu_io = apu.mmio;
-
-  const bool apu_enable = apu_io.soundcnt.master_enable;
-
-  switch(address) {
-    case FIFO_A: if(apu_enable) apu_io.fifo[0].WriteWord(value); break;
-    case FIFO_B: if(apu_enable) apu_io.fifo[1].WriteWord(value); break;
-
-    // Timers 0 - 3
-    case TM0CNT_L: timer.WriteWord(0, value); break;
-    case TM1CNT_L: timer.WriteWord(1, value); break;
-    case TM2CNT_L: timer.WriteWord(2, value); break;
-    case TM3CNT_L: timer.WriteWord(3, value); break;
-
-    default: {
-      WriteHalf(address + 0, u16(value >> 0));
-      WriteHalf(address + 2, u16(value >> 16));
-      break;
-    }
+  if(likely(address < g_io_table_limit)) {
+    g_io_write_word[(address & 0x3FF) >> 2](*this, address, value);
+    return;
   }
+
+  WriteHalf(address + 0, u16(value >> 0));
+  WriteHalf(address + 2, u16(value >> 16));
 }
 
 void Bus::SIOTransferDone() {
@@ -10,8 +10,6 @@
 namespace nba::core {
 
 void Bus::LoadState(SaveState const& state) {
-  memory.wram = state.bus.memory.wram;
-  memory.iram = state.bus.memory.iram;
   memory.latch.bios = state.bus.memory.latch.bios;
   memory.rom.LoadState(state);
 
@@ -34,7 +32,7 @@ void Bus::LoadState(SaveState const& state) {
   prefetch.active = state.bus.prefetch.active;
   prefetch.head_address = state.bus.prefetch.head_address;
   prefetch.count = state.bus.prefetch.count;
-  prefetch.countdown = state.bus.prefetch.countdown;
+  prefetch.timestamp_due = scheduler.GetTimestampNow() + state.bus.prefetch.countdown;
   prefetch.thumb = state.bus.prefetch.thumb;
   if(prefetch.thumb) {
     prefetch.opcode_width = sizeof(u16);
@@ -45,6 +43,7 @@ void Bus::LoadState(SaveState const& state) {
     prefetch.capacity = 4;
     prefetch.duty = wait32[int(Access::Sequential)][prefetch.last_address >> 24];
   }
+  prefetch.stalled = state.bus.prefetch.countdown <= 0 || prefetch.count >= prefetch.capacity;
 
   last_access = state.bus.last_access;
 
@@ -52,8 +51,6 @@ void Bus::LoadState(SaveState const& state) {
 }
 
 void Bus::CopyState(SaveState& state) {
-  state.bus.memory.wram = memory.wram;
-  state.bus.memory.iram = memory.iram;
   state.bus.memory.latch.bios = memory.latch.bios;
   memory.rom.CopyState(state);
 
@@ -72,10 +69,11 @@ void Bus::CopyState(SaveState& state) {
   state.bus.io.postflg = hw.postflg;
   state.bus.prefetch_buffer_was_disabled = hw.prefetch_buffer_was_disabled;
 
+  SyncPrefetch();
   state.bus.prefetch.active = prefetch.active;
   state.bus.prefetch.head_address = prefetch.head_address;
   state.bus.prefetch.count = prefetch.count;
-  state.bus.prefetch.countdown = prefetch.countdown;
+  state.bus.prefetch.countdown = (int)(prefetch.timestamp_due - scheduler.GetTimestampNow());
   state.bus.prefetch.thumb = prefetch.thumb;
 
   state.bus.last_access = last_access;
@@ -83,4 +81,19 @@ void Bus::CopyState(SaveState& state) {
   state.bus.parallel_internal_cpu_cycle_limit = parallel_internal_cpu_cycle_limit;
 }
 
+void Bus::LoadMemory(Snapshot::Memory& memory, bool swap) {
+  if(swap) {
+    this->memory.wram.swap(memory.wram);
+    this->memory.iram.swap(memory.iram);
+  } else {
+    this->memory.wram = memory.wram;
+    this->memory.iram = memory.iram;
+  }
+}
+
+void Bus::CopyMemory(Snapshot::Memory& memory) {
+  memory.wram = this->memory.wram;
+  memory.iram = this->memory.iram;
+}
+
 } // namespace nba::core
\ No newline at end of file
@@ -5,6 +5,8 @@
  * Refer to the included LICENSE file.
  */
 
+#include <algorithm>
+
 #include "arm/arm7tdmi.hpp"
 #include "bus/bus.hpp"
 
@@ -42,17 +44,23 @@ void Bus::Prefetch(u32 address, bool code, int cycles) {
   }
 
   if(prefetch.active) {
+    SyncPrefetch();
+
     // Case #1: requested address is the first entry in the prefetch buffer.
     if(prefetch.count != 0 && address == prefetch.head_address) {
-      prefetch.count--;
+      // While stalled, the cycle below makes another entry available right away.
+      if(!prefetch.stalled) {
+        prefetch.count--;
+      }
       prefetch.head_address += prefetch.opcode_width;
       Step(1);
       return;
     }
 
     // Case #2: requested address is currently being prefetched.
-    if(prefetch.countdown > 0 && address == prefetch.last_address) {
-      Step(prefetch.countdown);
+    if(!prefetch.stalled && address == prefetch.last_address) {
+      Step((int)(prefetch.timestamp_due - scheduler.GetTimestampNow()));
+      SyncPrefetch();
       prefetch.head_address = prefetch.last_address;
       prefetch.count = 0;
       return;
@@ -78,6 +86,7 @@ void Bus::Prefetch(u32 address, bool code, int cycles) {
 
     // The prefetch unit will be engaged and keeps the burst transfer alive.
     prefetch.active = true;
+    prefetch.stalled = false;
     prefetch.count = 0;
     prefetch.thumb = thumb;
     if(thumb) {
@@ -89,7 +98,7 @@ void Bus::Prefetch(u32 address, bool code, int cycles) {
       prefetch.capacity = 4;
       prefetch.duty = wait32[int(Access::Sequential)][page];
     }
-    prefetch.countdown = prefetch.duty;
+    prefetch.timestamp_due = scheduler.GetTimestampNow() + prefetch.duty;
     prefetch.last_address = address + prefetch.opcode_width;
     prefetch.head_address = prefetch.last_address;
   }
@@ -104,8 +113,10 @@ void Bus::StopPrefetch() {
      * Note: the prefetch unit is only active when executing code from ROM.
      */
     if(r15 >= 0x08000000 && r15 <= 0x0DFFFFFF) {
+      SyncPrefetch();
+
       auto half_duty_plus_one = (prefetch.duty >> 1) + 1;
-      auto countdown = prefetch.countdown;
+      auto countdown = (s64)(prefetch.timestamp_due - scheduler.GetTimestampNow());
 
       if(countdown == 1 || (!prefetch.thumb && countdown == half_duty_plus_one)) {
         Step(1);
@@ -116,23 +127,51 @@ void Bus::StopPrefetch() {
   }
 }
 
-void Bus::Step(int cycles) {
-  scheduler.AddCycles(cycles);
-
-  if(prefetch.active) {
-    prefetch.countdown -= cycles;
+void Bus::SyncPrefetch() {
+  if(!prefetch.active) {
+    return;
+  }
 
-    while(prefetch.countdown <= 0) {
-      prefetch.count++;
+  const u64 timestamp_now = scheduler.GetTimestampNow();
 
-      if(hw.waitcnt.prefetch && prefetch.count < prefetch.capacity) {
-        prefetch.last_address += prefetch.opcode_width;
-        prefetch.countdown += prefetch.duty;
-      } else {
-        break;
-      }
+  if(prefetch.stalled) {
+    // Once stalled, every bus cycle counts as another available entry.
+    if(prefetch.count == 0 && timestamp_now > prefetch.timestamp_due) {
+      prefetch.count = 1;
     }
+    return;
   }
+
+  if(timestamp_now < prefetch.timestamp_due) {
+    return;
+  }
+
+  // The opcode in flight has been fetched, but the unit has been disabled in the meantime.
+  if(!hw.waitcnt.prefetch) {
+    prefetch.count++;
+    prefetch.stalled = true;
+    return;
+  }
+
+  // Opcodes which have been fetched since the last update, including the one in flight.
+  const int fetched = (int)std::min<u64>(
+    (timestamp_now - prefetch.timestamp_due) / prefetch.duty + 1, prefetch.capacity - prefetch.count);
+
+  prefetch.count += fetched;
+
+  if(prefetch.count == prefetch.capacity) {
+    // The last opcode fills the buffer and no further opcode is requested.
+    prefetch.last_address += (fetched - 1) * prefetch.opcode_width;
+    prefetch.timestamp_due += (fetched - 1) * prefetch.duty;
+    prefetch.stalled = true;
+  } else {
+    prefetch.last_address += fetched * prefetch.opcode_width;
+    prefetch.timestamp_due += fetched * prefetch.duty;
+  }
+}
+
+void Bus::Step(int cycles) {
+  scheduler.AddCycles(cycles);
 }
 
 void Bus::UpdateWaitStateTable() {
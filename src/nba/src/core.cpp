@@ -20,11 +20,12 @@ Core::Core(std::shared_ptr<Config> config)
     , cpu(scheduler, bus)
     , irq(cpu, scheduler)
     , dma(bus, irq, scheduler)
-    , apu(scheduler, dma, bus, config)
+    , apu(scheduler, dma, bus, timer, config)
     , ppu(scheduler, irq, dma, config)
     , timer(scheduler, irq, apu)
     , keypad(scheduler, irq)
-    , bus(scheduler, {cpu, irq, dma, apu, ppu, timer, keypad}) {
+    , bus(scheduler, {cpu, irq, dma, apu, ppu, timer, keypad})
+    , bios_hle(bus) {
   Reset();
 }
 
@@ -38,11 +39,31 @@ void Core::Reset() {
   ppu.Reset();
   bus.Reset();
   keypad.Reset();
+  bios_hle.Reset();
 
-  if(config->skip_bios) {
+  cpu.SetProfiler(config->profiler.get());
+  scheduler.SetTracer(config->tracer.get());
+
+  bool use_stub_bios = false;
+
+  if(config->bios_hle) {
+    cpu.SetBIOSHLE(&bios_hle);
+    use_stub_bios = bios_hle.InstallStubBIOS();
+  } else {
+    cpu.SetBIOSHLE(nullptr);
+  }
+
+  // The stub BIOS cannot boot the system, so always skip the boot screen when using it.
+  if(config->skip_bios || use_stub_bios) {
     SkipBootScreen();
   }
 
+  if(use_stub_bios) {
+    // Like the real BIOS, hand over to the ROM with IRQs enabled.
+    cpu.state.cpsr.f.mask_irq = 0;
+    cpu.state.cpsr.f.mask_fiq = 0;
+  }
+
   if(config->audio.mp2k_hle_enable) {
     apu.GetMP2K().UseCubicFilter() = config->audio.mp2k_hle_cubic;
     apu.GetMP2K().ForceReverb() = config->audio.mp2k_hle_force_reverb;
@@ -75,6 +96,45 @@ void Core::SetKeyStatus(Key key, bool pressed) {
   keypad.SetKeyStatus(key, pressed);
 }
 
+void Core::SetVideoEnabled(bool enabled) {
+  ppu.SetVideoEnabled(enabled);
+}
+
+void Core::SetAudioEnabled(bool enabled) {
+  apu.SetAudioEnabled(enabled);
+}
+
+auto Core::GetAudioBufferFill() -> float {
+  return apu.GetBufferFill();
+}
+
+void Core::SetDirtyTrackingEnabled(bool enabled) {
+  for(int i = 0; i < (int)MemoryRegion::Count; i++) {
+    GetStateBlock((MemoryRegion)i).SetDirtyTrackingEnabled(enabled);
+  }
+}
+
+auto Core::GetDirtyPages(MemoryRegion region) -> std::vector<u64> const& {
+  return GetStateBlock(region).GetDirtyPages();
+}
+
+void Core::ClearDirtyPages(MemoryRegion region) {
+  GetStateBlock(region).ClearDirtyPages();
+}
+
+auto Core::GetStateBlock(MemoryRegion region) -> StateBlock& {
+  switch(region) {
+    case MemoryRegion::WRAM: return bus.memory.wram;
+    case MemoryRegion::IRAM: return bus.memory.iram;
+    case MemoryRegion::PRAM: return ppu.GetPRAMBlock();
+    case MemoryRegion::OAM:  return ppu.GetOAMBlock();
+    case MemoryRegion::VRAM: return ppu.GetVRAMBlock();
+    default: Assert(false, "Core: bad memory region: {}", (int)region);
+  }
+
+  return bus.memory.wram;
+}
+
 void Core::Run(int cycles) {
   using HaltControl = Bus::Hardware::HaltControl;
 
@@ -93,6 +153,13 @@ void Core::Run(int cycles) {
 
       cpu.Run();
     } else {
+      const auto tracer = scheduler.GetTracer();
+      Tracer::Record halt_span;
+
+      if(unlikely(tracer != nullptr)) {
+        halt_span = tracer->BeginSpan(Tracer::Type::Halt, scheduler.GetTimestampNow());
+      }
+
       while(scheduler.GetTimestampNow() < limit && !irq.ShouldUnhaltCPU()) {
         if(dma.IsRunning()) {
           dma.Run();
@@ -106,6 +173,10 @@ void Core::Run(int cycles) {
         bus.Step(1);
         bus.hw.haltcnt = HaltControl::Run;
       }
+
+      if(unlikely(tracer != nullptr)) {
+        tracer->EndSpan(halt_span);
+      }
     }
   }
 }
@@ -192,6 +263,10 @@ Scheduler& Core::GetScheduler() {
   return scheduler;
 }
 
+auto Core::GetConfig() -> Config& {
+  return *config;
+}
+
 } // namespace nba::core
 
 auto CreateCore(
@@ -10,6 +10,7 @@
 
 #include "arm/arm7tdmi.hpp"
 #include "bus/bus.hpp"
+#include "bus/hle/bios.hpp"
 #include "hw/apu/apu.hpp"
 #include "hw/ppu/ppu.hpp"
 #include "hw/dma/dma.hpp"
@@ -30,8 +31,17 @@ struct Core final : CoreBase {
   auto CreateSolarSensor() -> std::unique_ptr<SolarSensor> override;
   void LoadState(SaveState const& state) override;
   void CopyState(SaveState& state) override;
+  auto CreateSnapshot() -> SnapshotHandle override;
+  void CopySnapshot(Snapshot& snapshot) override;
+  void LoadSnapshot(SnapshotHandle snapshot) override;
+  void SetDirtyTrackingEnabled(bool enabled) override;
+  auto GetDirtyPages(MemoryRegion region) -> std::vector<u64> const& override;
+  void ClearDirtyPages(MemoryRegion region) override;
   void SetKeyStatus(Key key, bool pressed) override;
   void Run(int cycles) override;
+  void SetVideoEnabled(bool enabled) override;
+  void SetAudioEnabled(bool enabled) override;
+  auto GetAudioBufferFill() -> float override;
 
   auto GetROM() -> ROM& override;
   auto GetPRAM() -> u8* override;
@@ -44,10 +54,14 @@ struct Core final : CoreBase {
   auto GetBGVOFS(int id) -> u16 override;
 
   Scheduler& GetScheduler() override;
+  auto GetConfig() -> Config& override;
 
 private:
   void SkipBootScreen();
   auto SearchSoundMainRAM() -> u32;
+  void LoadStateExceptMemory(SaveState const& state);
+  void CopyStateExceptMemory(SaveState& state);
+  auto GetStateBlock(MemoryRegion region) -> StateBlock&;
 
   u32 hle_audio_hook;
   std::shared_ptr<Config> config;
@@ -62,6 +76,9 @@ private:
   Timer timer;
   KeyPad keypad;
   Bus bus;
+  BIOSHLE bios_hle;
+
+  SnapshotHandle spare_snapshot;
 };
 
 } // namespace nba::core
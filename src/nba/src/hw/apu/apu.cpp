@@ -6,12 +6,14 @@
  */
 
 #include <algorithm>
+#include <climits>
 #include <cmath>
 #include <nba/common/dsp/resampler/cosine.hpp>
 #include <nba/common/dsp/resampler/cubic.hpp>
 #include <nba/common/dsp/resampler/nearest.hpp>
 #include <nba/common/dsp/resampler/sinc.hpp>
 
+#include "hw/timer/timer.hpp"
 #include "apu.hpp"
 
 namespace nba::core {
@@ -20,10 +22,12 @@ APU::APU(
   Scheduler& scheduler,
   DMA& dma,
   Bus& bus,
+  Timer& timer,
   std::shared_ptr<Config> config
 )   : mmio(scheduler)
     , scheduler(scheduler)
     , dma(dma)
+    , timer(timer)
     , mp2k(bus)
     , config(config) {
   scheduler.Register(Scheduler::EventClass::APU_mixer, this, &APU::StepMixer);
@@ -85,6 +89,16 @@ void APU::Reset() {
   resampler->SetSampleRates(mmio.bias.GetSampleRate(), audio_dev->GetSampleRate());
 }
 
+auto APU::GetBufferFill() -> float {
+  std::lock_guard<std::mutex> guard(buffer_mutex);
+
+  if(!buffer) {
+    return 0;
+  }
+
+  return (float)buffer->Available() / buffer->Capacity();
+}
+
 void APU::OnTimerOverflow(int timer_id, int times) {
   auto const& soundcnt = mmio.soundcnt;
 
@@ -99,31 +113,61 @@ void APU::OnTimerOverflow(int timer_id, int times) {
       auto& fifo = mmio.fifo[fifo_id];
       auto& pipe = fifo_pipe[fifo_id];
 
-      if(fifo.Count() <= 3) {
-        dma.Request(occasion[fifo_id]);
-      }
+      for(int i = 0; i < times; i++) {
+        if(fifo.Count() <= 3) {
+          dma.Request(occasion[fifo_id]);
+        }
 
-      if(pipe.size == 0 && fifo.Count() > 0) {
-        pipe.word = fifo.ReadWord();
-        pipe.size = 4;
+        if(pipe.size == 0 && fifo.Count() > 0) {
+          pipe.word = fifo.ReadWord();
+          pipe.size = 4;
+        }
+
+        s8 sample = (s8)(u8)pipe.word;
+
+        if(pipe.size > 0) {
+          pipe.word >>= 8;
+          pipe.size--;
+        }
+
+        latch[fifo_id] = sample;
       }
+    }
+  }
+}
+
+auto APU::GetLazyOverflowLimit(int timer_id) -> int {
+  auto const& soundcnt = mmio.soundcnt;
 
-      s8 sample = (s8)(u8)pipe.word;
+  int limit = INT_MAX;
 
-      if(pipe.size > 0) {
-        pipe.word >>= 8;
-        pipe.size--;
+  if(!soundcnt.master_enable) {
+    return limit;
+  }
+
+  for(int fifo_id = 0; fifo_id < 2; fifo_id++) {
+    if(soundcnt.dma[fifo_id].timer_id == timer_id) {
+      const int count = mmio.fifo[fifo_id].Count();
+
+      if(count <= 3) {
+        return 0;
       }
 
-      latch[fifo_id] = sample;
+      // The pipe is drained first, then every word from the FIFO lasts four overflows.
+      // The FIFO DMA is requested on the first overflow that finds three or less words in the FIFO.
+      limit = std::min(limit, fifo_pipe[fifo_id].size + 4 * count - 15);
     }
   }
+
+  return limit;
 }
 
 void APU::StepMixer() {
   constexpr int psg_volume_tab[4] = { 1, 2, 4, 0 };
   constexpr int dma_volume_tab[2] = { 2, 4 };
 
+  timer.SyncFIFOTimers();
+
   auto& psg = mmio.soundcnt.psg;
   auto& dma = mmio.soundcnt.dma;
 
@@ -133,7 +177,9 @@ void APU::StepMixer() {
     StereoSample<float> sample { 0, 0 };
 
     if(resolution_old != 1) {
+      buffer_mutex.lock();
       resampler->SetSampleRates(65536, config->audio_dev->GetSampleRate());
+      buffer_mutex.unlock();
       resolution_old = 1;
     }
 
@@ -161,9 +207,11 @@ void APU::StepMixer() {
 
     if(!mmio.soundcnt.master_enable) sample = {};
 
-    buffer_mutex.lock();
-    resampler->Write(sample);
-    buffer_mutex.unlock();
+    if(audio_enabled) {
+      buffer_mutex.lock();
+      resampler->Write(sample);
+      buffer_mutex.unlock();
+    }
 
     scheduler.Add(256 - (scheduler.GetTimestampNow() & 255), Scheduler::EventClass::APU_mixer);
   } else {
@@ -172,7 +220,9 @@ void APU::StepMixer() {
     auto& bias = mmio.bias;
 
     if(bias.resolution != resolution_old) {
+      buffer_mutex.lock();
       resampler->SetSampleRates(bias.GetSampleRate(), config->audio_dev->GetSampleRate());
+      buffer_mutex.unlock();
       resolution_old = mmio.bias.resolution;
     }
 
@@ -199,9 +249,11 @@ void APU::StepMixer() {
 
     if(!mmio.soundcnt.master_enable) sample = {};
 
-    buffer_mutex.lock();
-    resampler->Write({ sample[0] / float(0x200), sample[1] / float(0x200) });
-    buffer_mutex.unlock();
+    if(audio_enabled) {
+      buffer_mutex.lock();
+      resampler->Write({ sample[0] / float(0x200), sample[1] / float(0x200) });
+      buffer_mutex.unlock();
+    }
 
     const int sample_interval = mmio.bias.GetSampleInterval();
     const int cycles = sample_interval - (scheduler.GetTimestampNow() & (sample_interval - 1));
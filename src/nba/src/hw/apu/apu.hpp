@@ -24,6 +24,8 @@
 
 namespace nba::core {
 
+struct Timer;
+
 // See callback.cpp for implementation
 void AudioCallback(struct APU* apu, s16* stream, int byte_len);
 
@@ -32,6 +34,7 @@ struct APU {
     Scheduler& scheduler,
     DMA& dma,
     Bus& bus,
+    Timer& timer,
     std::shared_ptr<Config>
   );
 
@@ -41,9 +44,18 @@ struct APU {
   auto GetMP2K() -> MP2K& { return mp2k; }
   void OnTimerOverflow(int timer_id, int times);
 
+  // Returns how many of the next overflows of a timer do not request a FIFO DMA.
+  auto GetLazyOverflowLimit(int timer_id) -> int;
+
   void LoadState(SaveState const& state);
   void CopyState(SaveState& state);
 
+  void SetAudioEnabled(bool enabled) {
+    audio_enabled = enabled;
+  }
+
+  auto GetBufferFill() -> float;
+
   struct MMIO {
     MMIO(Scheduler& scheduler)
         : psg1(scheduler, Scheduler::EventClass::APU_PSG1_generate)
@@ -82,10 +94,12 @@ private:
 
   Scheduler& scheduler;
   DMA& dma;
+  Timer& timer;
   MP2K mp2k;
   int mp2k_read_index;
   std::shared_ptr<Config> config;
   int resolution_old = 0;
+  bool audio_enabled = true;
 };
 
 } // namespace nba::core
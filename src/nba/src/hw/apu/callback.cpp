@@ -24,6 +24,14 @@ void AudioCallback(APU* apu, s16* stream, int byte_len) {
   int available = apu->buffer->Available();
 
   static constexpr float kMaxAmplitude = 0.999;
+  static constexpr float kMaxRateAdjustment = 0.005;
+
+  if(apu->config->audio.dynamic_rate_control) {
+    // Produce more samples while the buffer is less than half full and fewer samples while it is more than half full.
+    const float fill = (float)available / apu->buffer->Capacity();
+
+    apu->resampler->SetRateAdjustment(1 + kMaxRateAdjustment * (1 - 2 * fill));
+  }
 
   const float volume = (float)std::clamp(apu->config->audio.volume, 0, 100) / 100.0f;
 
@@ -8,6 +8,7 @@
 #include <cstring>
 
 #include "hw/apu/apu.hpp"
+#include "hw/timer/timer.hpp"
 
 namespace nba::core {
 
@@ -35,6 +36,8 @@ void APU::LoadState(SaveState const& state) {
 }
 
 void APU::CopyState(SaveState& state) {
+  timer.SyncFIFOTimers();
+
   state.apu.io.soundcnt = mmio.soundcnt.ReadWord();
   state.apu.io.soundbias = mmio.bias.ReadHalf();
 
@@ -5,7 +5,10 @@
  * Refer to the included LICENSE file.
  */
 
+#include <algorithm>
+#include <cstring>
 #include <nba/common/compiler.hpp>
+#include <nba/common/punning.hpp>
 
 #include "bus/bus.hpp"
 #include "bus/io.hpp"
@@ -160,7 +163,13 @@ auto DMA::Run() -> int {
   bus.Step(1);
 
   do {
-    RunChannel();
+    if(unlikely(scheduler.GetTracer() != nullptr)) {
+      auto span = scheduler.GetTracer()->BeginSpan(Tracer::Type::DMA, scheduler.GetTimestampNow(), active_dma_id);
+      RunChannel();
+      scheduler.GetTracer()->EndSpan(span);
+    } else {
+      RunChannel();
+    }
   } while(IsRunning());
 
   bus.Step(1);
@@ -184,12 +193,21 @@ void DMA::RunChannel() {
 
   bool did_access_rom = false;
 
+  // FIFO DMA and DMA reading from BIOS (open bus) or going backwards always take the slow path.
+  const bool try_bulk = !channel.is_fifo_dma &&
+                         channel.latch.src_addr >= 0x02000000 &&
+                         src_modify >= 0 && dst_modify > 0;
+
   while(channel.latch.length != 0) {
     if(should_reenter_transfer_loop) {
       should_reenter_transfer_loop = false;
       return;
     }
 
+    if(try_bulk && RunChannelBulk(channel, src_modify, dst_modify, did_access_rom)) {
+      continue;
+    }
+
     auto src_addr = channel.latch.src_addr;
     auto dst_addr = channel.latch.dst_addr;
 
@@ -267,6 +285,202 @@ void DMA::RunChannel() {
   SelectNextDMA();
 }
 
+bool DMA::RunChannelBulk(Channel& channel, int src_modify, int dst_modify, bool& did_access_rom) {
+  const bool word = channel.size == Channel::Word;
+  const u32 unit = word ? sizeof(u32) : sizeof(u16);
+
+  const u32 src_addr = channel.latch.src_addr;
+  const u32 dst_addr = channel.latch.dst_addr;
+  const int src_page = src_addr >> 24;
+  const int dst_page = dst_addr >> 24;
+
+  // Only plain memory can be transferred in bulk. SRAM, EEPROM (0x0D) and IO must go through the bus.
+  const bool src_rom = src_page >= 0x08 && src_page <= 0x0C;
+
+  if(src_page != 0x02 && src_page != 0x03 && !src_rom) {
+    return false;
+  }
+
+  // Reading ROM sequentially advances the address latch, so a fixed ROM source does not read the same unit twice.
+  if(src_rom && src_modify == 0) {
+    return false;
+  }
+
+  switch(dst_page) {
+    case 0x02:
+    case 0x03:
+      break;
+    case 0x05:
+    case 0x06:
+    case 0x07: {
+      // Outside of V-blank the PPU competes for video memory, which is emulated per access.
+      // Line 227 is excluded, because the sprite engine already fetches the first line.
+      const uint vcount = bus.hw.ppu.mmio.vcount;
+
+      if(vcount < 160U || vcount >= 227U) {
+        return false;
+      }
+      break;
+    }
+    default:
+      return false;
+  }
+
+  auto& wait = word ? bus.wait32 : bus.wait16;
+
+  const int cycles_write = wait[int(Bus::Sequential)][dst_page];
+  const int cycles_seq = wait[int(Bus::Sequential)][src_page] + cycles_write;
+  const int cycles_nonseq_penalty = wait[int(Bus::Nonsequential)][src_page] - wait[int(Bus::Sequential)][src_page];
+
+  if(src_rom) {
+    // The first ROM access of the transfer may pay a penalty if the prefetch unit is active.
+    bus.StopPrefetch();
+  }
+
+  // The transfer must end before the next event, which may raise an IRQ, request another DMA or
+  // touch memory. Whatever does not fit is left to the per-unit loop.
+  const int cycles_available = scheduler.GetRemainingCycleCount() - 1;
+
+  if(cycles_available < cycles_seq) {
+    return false;
+  }
+
+  const auto count_nonseq_accesses = [&](u32 units) -> u32 {
+    if(!src_rom) {
+      return 0;
+    }
+
+    // ROM accesses are non-sequential at the start of the transfer and at each 128 KiB boundary.
+    const u32 begin = src_addr & 0x01FF'FFFF;
+    const u32 end = begin + units * unit;
+    u32 count = ((end + 0x1'FFFF) >> 17) - ((begin + 0x1'FFFF) >> 17);
+
+    if(!did_access_rom && (begin & 0x1'FFFF) != 0) {
+      count++;
+    }
+    return count;
+  };
+
+  u32 units = std::min<u32>(channel.latch.length, (u32)(cycles_available / cycles_seq));
+  u64 cycles;
+
+  while(true) {
+    cycles = (u64)units * cycles_seq + (u64)count_nonseq_accesses(units) * cycles_nonseq_penalty;
+
+    if(units == 0 || cycles <= (u64)cycles_available) {
+      break;
+    }
+    units--;
+  }
+
+  if(units == 0) {
+    return false;
+  }
+
+  const u32 dst_length = units * unit;
+  const u32 src_length = src_modify != 0 ? dst_length : unit;
+
+  u8* src = GetBulkHostAddress(src_addr, src_length, false);
+  u8* dst = GetBulkHostAddress(dst_addr, dst_length, true);
+
+  if(src == nullptr || dst == nullptr) {
+    return false;
+  }
+
+  // The per-unit loop propagates overlapping data forward, which a plain copy would not.
+  if(src_modify != 0 && src < dst + dst_length && dst < src + src_length) {
+    return false;
+  }
+
+  bus.Step((int)cycles);
+
+  if(dst_page >= 0x05) {
+    bus.hw.ppu.Sync();
+  }
+
+  if(src_modify != 0) {
+    std::memcpy(dst, src, dst_length);
+  } else if(word) {
+    const u32 value = read<u32>(src, 0);
+
+    for(u32 offset = 0; offset < dst_length; offset += unit) {
+      write<u32>(dst, offset, value);
+    }
+  } else {
+    const u16 value = read<u16>(src, 0);
+
+    for(u32 offset = 0; offset < dst_length; offset += unit) {
+      write<u16>(dst, offset, value);
+    }
+  }
+
+  bus.MarkDirty(dst_addr, dst_length);
+
+  // Update the open bus latches and the ROM address latch as if the last unit had been read through the bus.
+  const u32 last_offset = src_length - unit;
+
+  if(word) {
+    if(src_rom) {
+      channel.latch.bus = bus.memory.rom.ReadROM32(src_addr + last_offset, false);
+    } else {
+      channel.latch.bus = read<u32>(src, last_offset);
+    }
+  } else {
+    u16 value;
+
+    if(src_rom) {
+      value = bus.memory.rom.ReadROM16(src_addr + last_offset, false);
+    } else {
+      value = read<u16>(src, last_offset);
+    }
+    channel.latch.bus = (value << 16) | value;
+  }
+  latch = channel.latch.bus;
+
+  channel.latch.src_addr += src_modify * units;
+  channel.latch.dst_addr += dst_modify * units;
+  channel.latch.length -= units;
+
+  if(src_rom) {
+    did_access_rom = true;
+  }
+
+  bus.last_access = Bus::Sequential | Bus::Dma;
+  bus.parallel_internal_cpu_cycle_limit = 0;
+  return true;
+}
+
+auto DMA::GetBulkHostAddress(u32 address, u32 size, bool write) -> u8* {
+  const u32 offset = address & 0x00FF'FFFF;
+
+  switch(address >> 24) {
+    case 0x05: {
+      return offset + size <= 0x400 ? bus.hw.ppu.GetPRAM() + offset : nullptr;
+    }
+    case 0x06: {
+      return offset + size <= 0x18000 ? bus.hw.ppu.GetVRAM() + offset : nullptr;
+    }
+    case 0x07: {
+      return offset + size <= 0x400 ? bus.hw.ppu.GetOAM() + offset : nullptr;
+    }
+    case 0x08:
+    case 0x09:
+    case 0x0A:
+    case 0x0B:
+    case 0x0C: {
+      const u32 rom_offset = address & 0x01FF'FFFF;
+
+      // GPIO registers may be mapped over the ROM.
+      if(write || (rom_offset < 0xCA && rom_offset + size > 0xC4)) {
+        return nullptr;
+      }
+      break;
+    }
+  }
+
+  return bus.GetHostAddress(address, size);
+}
+
 auto DMA::Read(int chan_id, int offset) -> u8 {
   auto const& channel = channels[chan_id];
 
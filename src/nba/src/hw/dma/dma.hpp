@@ -113,6 +113,8 @@ private:
   void AddChannelToDMASet(Channel& channel);
   void RemoveChannelFromDMASets(Channel& channel);
   void RunChannel();
+  bool RunChannelBulk(Channel& channel, int src_modify, int dst_modify, bool& did_access_rom);
+  auto GetBulkHostAddress(u32 address, u32 size, bool write) -> u8*;
 
   Bus& bus;
   IRQ& irq;
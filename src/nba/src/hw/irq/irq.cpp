@@ -131,6 +131,13 @@ void IRQ::Raise(IRQ::Source source, int channel) {
       break;
   }
 
+  if(unlikely(scheduler.GetTracer() != nullptr)) {
+    // Translate the IRQ source into its bit index in the IF register.
+    const int flag = (int)source + (source >= Source::Serial ? 3 : 0) + (source > Source::DMA ? 3 : 0) + channel;
+
+    scheduler.GetTracer()->Add(Tracer::Type::IRQ, scheduler.GetTimestampNow(), (u16)flag);
+  }
+
   scheduler.Add(1, Scheduler::EventClass::IRQ_write_io, 0);
 }
 
@@ -29,6 +29,11 @@ void PPU::InitMerge() {
   merge.mosaic_x[1] = 0U;
   merge.forced_blank = false;
   merge.sprite_pixel_latch.data = 0U;
+  merge.compose = !config->skip_frame_composition;
+
+  if(!merge.compose) {
+    skipped_composition = true;
+  }
 }
 
 void PPU::DrawMerge() {
@@ -41,11 +46,20 @@ void PPU::DrawMerge() {
   }
 
   // @todo: possibly template this based on IO configuration
-  DrawMergeImpl(cycles);
+  if(merge.compose) {
+    DrawMergeImpl<true>(cycles);
+  } else {
+    DrawMergeImpl<false>(cycles);
+  }
 
   merge.timestamp_last_sync = timestamp_now;
 }
 
+/**
+ * Without composition, only the layer selection is done. It decides which PRAM accesses happen (and thus the PRAM contention)
+ * and updates the OBJ mosaic latch. The colors are neither read from PRAM nor blended and nothing is written to the output.
+ */
+template<bool compose>
 void PPU::DrawMergeImpl(int cycles) {
   static constexpr int k_min_max_bg[8][2] {
     {0,  3}, // Mode 0 (BG0 - BG3 text-mode)
@@ -180,7 +194,11 @@ void PPU::DrawMergeImpl(int cycles) {
 
         // @todo: make it clear what the meaning of 0x8000'0000 is.
         if((colors[0] & 0x8000'0000) == 0) {
-          colors[0] = FetchPRAM(merge.cycle, colors[0] << 1);
+          if constexpr(compose) {
+            colors[0] = FetchPRAM(merge.cycle, colors[0] << 1);
+          } else {
+            TouchPRAM(merge.cycle);
+          }
         }
       } else {
         colors[0] = 0x7FFFU; // output white
@@ -192,10 +210,16 @@ void PPU::DrawMergeImpl(int cycles) {
         if(merge.force_alpha_blend && have_src) {
           // @todo: make it clear what the meaning of 0x8000'0000 is.
           if((colors[1] & 0x8000'0000) == 0) {
-            colors[1] = FetchPRAM(merge.cycle, colors[1] << 1);
+            if constexpr(compose) {
+              colors[1] = FetchPRAM(merge.cycle, colors[1] << 1);
+            } else {
+              TouchPRAM(merge.cycle);
+            }
           }
 
-          colors[0] = Blend(colors[0], colors[1], mmio.eva, mmio.evb);
+          if constexpr(compose) {
+            colors[0] = Blend(colors[0], colors[1], mmio.eva, mmio.evb);
+          }
         } else if(!have_windows || win_layer_enable[LAYER_SFX]) {
           const bool have_dst = mmio.bldcnt.targets[0][layers[0]];
 
@@ -204,21 +228,27 @@ void PPU::DrawMergeImpl(int cycles) {
               if(have_dst && have_src) {
                 // @todo: make it clear what the meaning of 0x8000'0000 is.
                 if((colors[1] & 0x8000'0000) == 0) {
-                  colors[1] = FetchPRAM(merge.cycle, colors[1] << 1);
+                  if constexpr(compose) {
+                    colors[1] = FetchPRAM(merge.cycle, colors[1] << 1);
+                  } else {
+                    TouchPRAM(merge.cycle);
+                  }
                 }
 
-                colors[0] = Blend(colors[0], colors[1], mmio.eva, mmio.evb);
+                if constexpr(compose) {
+                  colors[0] = Blend(colors[0], colors[1], mmio.eva, mmio.evb);
+                }
               }
               break;
             }
             case BlendControl::SFX_BRIGHTEN: {
-              if(have_dst) {
+              if(compose && have_dst) {
                 colors[0] = Brighten(colors[0], mmio.evy);
               }
               break;
             }
             case BlendControl::SFX_DARKEN: {
-              if(have_dst) {
+              if(compose && have_dst) {
                 colors[0] = Darken(colors[0], mmio.evy);
               }
               break;
@@ -227,26 +257,28 @@ void PPU::DrawMergeImpl(int cycles) {
         }
       }
 
-      if(x & 1) {
-        u16 color_l = merge.color_l;
-        u16 color_r = colors[0];
+      if constexpr(compose) {
+        if(x & 1) {
+          u16 color_l = merge.color_l;
+          u16 color_r = colors[0];
 
-        if(mmio.greenswap & 1) {
-          const u16 mask = 31U << 5;
+          if(mmio.greenswap & 1) {
+            const u16 mask = 31U << 5;
 
-          u16 g_l = color_l & mask;
-          u16 g_r = color_r & mask;
+            u16 g_l = color_l & mask;
+            u16 g_r = color_r & mask;
 
-          color_l = (color_l & ~mask) | g_r;
-          color_r = (color_r & ~mask) | g_l;
-        }
+            color_l = (color_l & ~mask) | g_r;
+            color_r = (color_r & ~mask) | g_l;
+          }
 
-        u32* out = &output[frame][mmio.vcount * 240 + (x & ~1)];
+          u32* out = &output[frame][mmio.vcount * 240 + (x & ~1)];
 
-        out[0] = RGB555(color_l);
-        out[1] = RGB555(color_r);
-      } else {
-        merge.color_l = colors[0];
+          out[0] = RGB555(color_l);
+          out[1] = RGB555(color_r);
+        } else {
+          merge.color_l = colors[0];
+        }
       }
 
       if(++merge.mosaic_x[0] == (uint)mmio.mosaic.bg.size_x) {
@@ -39,9 +39,9 @@ PPU::PPU(
 }
 
 void PPU::Reset() {
-  std::memset(pram, 0, 0x00400);
-  std::memset(oam,  0, 0x00400);
-  std::memset(vram, 0, 0x18000);
+  pram.fill(0);
+  oam.fill(0);
+  vram.fill(0);
 
   vram_bg_latch = 0U;
 
@@ -100,7 +100,11 @@ void PPU::Reset() {
   window = {};
   merge = {};
 
+  // The first frame is presented before any of its scanlines has been composed.
+  std::memset(output, 0, sizeof(output));
+
   frame = 0;
+  skipped_composition = false;
   dma3_video_transfer_running = false;
 }
 
@@ -177,8 +181,15 @@ void PPU::BeginHDrawVBlank() {
     scheduler.Add(1007, Scheduler::EventClass::PPU_hblank_vdraw);
     vcount = 0;
 
-    config->video_dev->Draw(output[frame]);
+    if(video_enabled && !skipped_composition) {
+      config->video_dev->Draw(output[frame]);
+    }
     frame ^= 1;
+    skipped_composition = false;
+
+    if(unlikely(scheduler.GetTracer() != nullptr)) {
+      scheduler.GetTracer()->Add(Tracer::Type::Frame, scheduler.GetTimestampNow());
+    }
 
     InitBackground();
     InitMerge();
@@ -250,6 +261,9 @@ void PPU::UpdateVideoTransferDMA() {
 }
 
 void PPU::LatchDISPCNT() {
+  // Render the background up to here with the old value, independent of when video memory was last accessed.
+  DrawBackground();
+
   mmio.dispcnt_latch[0] = mmio.dispcnt_latch[1];
   mmio.dispcnt_latch[1] = mmio.dispcnt_latch[2];
   mmio.dispcnt_latch[2] = mmio.dispcnt.hword;
@@ -10,10 +10,12 @@
 #include <functional>
 #include <nba/common/compiler.hpp>
 #include <nba/common/punning.hpp>
+#include <nba/common/state_block.hpp>
 #include <nba/config.hpp>
 #include <nba/integer.hpp>
 #include <nba/save_state.hpp>
 #include <nba/scheduler.hpp>
+#include <nba/snapshot.hpp>
 #include <type_traits>
 
 #include "hw/ppu/registers.hpp"
@@ -34,31 +36,50 @@ struct PPU {
 
   void LoadState(SaveState const& state);
   void CopyState(SaveState& state);
+  void LoadMemory(Snapshot::Memory& memory, bool swap);
+  void CopyMemory(Snapshot::Memory& memory);
+
+  void SetVideoEnabled(bool enabled) {
+    video_enabled = enabled;
+  }
 
   auto GetPRAM() -> u8* {
-    return pram;
+    return pram.data();
   }
 
   auto GetVRAM() -> u8* {
-    return vram;
+    return vram.data();
   }
 
   auto GetOAM() -> u8* {
+    return oam.data();
+  }
+
+  auto GetPRAMBlock() -> StateBlock& {
+    return pram;
+  }
+
+  auto GetVRAMBlock() -> StateBlock& {
+    return vram;
+  }
+
+  auto GetOAMBlock() -> StateBlock& {
     return oam;
   }
 
   template<typename T>
   auto ALWAYS_INLINE ReadPRAM(u32 address) noexcept -> T {
-    return read<T>(pram, address & 0x3FF);
+    return read<T>(pram.data(), address & 0x3FF);
   }
 
   template<typename T>
   void ALWAYS_INLINE WritePRAM(u32 address, T value) noexcept {
     if constexpr (std::is_same_v<T, u8>) {
-      write<u16>(pram, address & 0x3FE, value * 0x0101);
+      write<u16>(pram.data(), address & 0x3FE, value * 0x0101);
     } else {
-      write<T>(pram, address & 0x3FF, value);
+      write<T>(pram.data(), address & 0x3FF, value);
     }
+    pram.MarkDirty(address & 0x3FF);
   }
 
   auto ALWAYS_INLINE GetSpriteVRAMBoundary() noexcept -> u32 {
@@ -67,7 +88,7 @@ struct PPU {
 
   template<typename T>
   auto ALWAYS_INLINE ReadVRAM_BG(u32 address) noexcept -> T {
-    return read<T>(vram, address);
+    return read<T>(vram.data(), address);
   }
 
   template<typename T>
@@ -81,7 +102,7 @@ struct PPU {
       }
     }
 
-    return read<T>(vram, address);
+    return read<T>(vram.data(), address);
   }
 
   template<typename T>
@@ -100,10 +121,11 @@ struct PPU {
   template<typename T>
   auto ALWAYS_INLINE WriteVRAM_BG(u32 address, T value) noexcept {
     if constexpr (std::is_same_v<T, u8>) {
-      write<u16>(vram, address & ~1, value * 0x0101);
+      write<u16>(vram.data(), address & ~1, value * 0x0101);
     } else {
-      write<T>(vram, address, value);
+      write<T>(vram.data(), address, value);
     }
+    vram.MarkDirty(address);
   }
 
   template<typename T>
@@ -117,19 +139,21 @@ struct PPU {
         }
       }
 
-      write<T>(vram, address, value);
+      write<T>(vram.data(), address, value);
+      vram.MarkDirty(address);
     }
   }
 
   template<typename T>
   auto ALWAYS_INLINE ReadOAM(u32 address) noexcept -> T {
-    return read<T>(oam, address & 0x3FF);
+    return read<T>(oam.data(), address & 0x3FF);
   }
 
   template<typename T>
   void ALWAYS_INLINE WriteOAM(u32 address, T value) noexcept {
     if constexpr (!std::is_same_v<T, u8>) {
-      write<T>(oam, address & 0x3FF, value);
+      write<T>(oam.data(), address & 0x3FF, value);
+      oam.MarkDirty(address & 0x3FF);
     }
   }
 
@@ -149,10 +173,33 @@ struct PPU {
     return scheduler.GetTimestampNow() == sprite.timestamp_oam_access + 1U;
   }
 
+  /**
+   * The Is*Idle() predicates return true if the respective engine cannot access its memory
+   * before the next time it is synchronized. Accesses to that memory then neither stall nor need a sync.
+   */
+  bool ALWAYS_INLINE IsBackgroundIdle() const noexcept {
+    return bg.cycle >= 1232U || ForcedBlank() || (mmio.dispcnt_latch[0] & mmio.dispcnt.hword & 0x0F00U) == 0U;
+  }
+
+  bool ALWAYS_INLINE IsSpriteIdle() const noexcept {
+    return sprite.cycle >= sprite.latch_cycle_limit || !mmio.dispcnt.enable[LAYER_OBJ];
+  }
+
+  bool ALWAYS_INLINE IsMergeIdle() const noexcept {
+    return merge.cycle >= 1006U || ForcedBlank();
+  }
+
+  // Only the background engine reads BG VRAM, so it can be synchronized on its own.
+  void SyncBackground() {
+    DrawBackground();
+  }
+
+  // Only the sprite engine reads OBJ VRAM and OAM, so it can be synchronized on its own.
+  void SyncSprite() {
+    DrawSprite();
+  }
+
   void Sync() {
-    // @todo: only update the window when it is necessary or else
-    // we will have a major performance caveat due to the window being updated 
-    // during V-blank and games typically updating graphics during V-blank.
     DrawBackground();
     DrawSprite();
     DrawWindow();
@@ -377,10 +424,17 @@ private:
     bool h_flag[2] {false, false};
 
     bool buffer[240][2];
+
+    // Inputs of the current scanline and of the scanline held in the buffer (see GetWindowKey()).
+    u64 line_key = ~0ULL;
+    u64 buffer_key = ~0ULL;
+    bool line_fill = false;
+    bool line_partial = false; // parts of the scanline were not written, because WIN0 and WIN1 were disabled
   } window;
 
   void InitWindow();
   void DrawWindow();
+  auto GetWindowKey() const -> u64;
 
   struct Merge {
     u64 timestamp_init = 0;
@@ -394,11 +448,12 @@ private:
     u16 color_l;
     bool forced_blank;
     Sprite::Pixel sprite_pixel_latch;
+    bool compose = true;
   } merge;
 
   void InitMerge();
   void DrawMerge();
-  void DrawMergeImpl(int cycles);
+  template<bool compose> void DrawMergeImpl(int cycles);
   
   static auto Blend(u16 color_a, u16 color_b, int eva, int evb) -> u16;
   static auto Brighten(u16 color, int evy) -> u16;
@@ -409,8 +464,13 @@ private:
   }
 
   auto ALWAYS_INLINE FetchPRAM(uint cycle, uint address) -> u16 {
+    TouchPRAM(cycle);
+    return read<u16>(pram.data(), address);
+  }
+
+  // Only records the access for the PRAM contention, without reading the color.
+  void ALWAYS_INLINE TouchPRAM(uint cycle) {
     merge.timestamp_pram_access = merge.timestamp_init + cycle;
-    return read<u16>(pram, address);
   }
 
   template<typename T>
@@ -421,8 +481,8 @@ private:
 
     if(likely(address < GetSpriteVRAMBoundary())) {
       bg.timestamp_vram_access = bg.timestamp_init + cycle;
-      vram_bg_latch = read<u16>(vram, address & ~1U);
-      return read<T>(vram, address);
+      vram_bg_latch = read<u16>(vram.data(), address & ~1U);
+      return read<T>(vram.data(), address);
     }
     return read<T>(&vram_bg_latch, address & 1U);
   }
@@ -432,7 +492,7 @@ private:
     // @todo: OBJ circuitry seems to ignore 'forced blank'. But is that really true?
     if(likely(address >= GetSpriteVRAMBoundary())) {
       sprite.timestamp_vram_access = sprite.timestamp_init + cycle;
-      return read<T>(vram, address);
+      return read<T>(vram.data(), address);
     }
     return 0u;
   }
@@ -440,12 +500,12 @@ private:
   template<typename T>
   auto ALWAYS_INLINE FetchOAM(uint cycle, uint address) -> T {
     sprite.timestamp_oam_access = sprite.timestamp_init + cycle;
-    return read<T>(oam, address);
+    return read<T>(oam.data(), address);
   }
 
-  u8 pram[0x00400];
-  u8 oam [0x00400];
-  u8 vram[0x18000];
+  StateBlock pram{0x00400};
+  StateBlock oam {0x00400};
+  StateBlock vram{0x18000};
 
   u16 vram_bg_latch;
 
@@ -453,10 +513,14 @@ private:
   IRQ& irq;
   DMA& dma;
   std::shared_ptr<Config> config;
+  bool video_enabled = true;
 
   u32 output[2][240 * 160];
   int frame;
 
+  // Composition was skipped for some of the scanlines of the current frame, so it must not be presented.
+  bool skipped_composition;
+
   bool dma3_video_transfer_running;
 
   #include "background.inl"
@@ -5,8 +5,6 @@
  * Refer to the included LICENSE file.
  */
 
-#include <cstring>
-
 #include "ppu.hpp"
 
 namespace nba::core {
@@ -61,12 +59,11 @@ void PPU::LoadState(SaveState const& state) {
   mmio.evb = (ss_ppu.io.bldalpha >> 8) & 31;
   mmio.evy = ss_ppu.io.bldy & 31;
 
-  std::memcpy(pram, state.bus.memory.pram, 0x400);
-  std::memcpy(oam,  state.bus.memory.oam,  0x400);
-  std::memcpy(vram, state.bus.memory.vram, 0x18000);
-
   vram_bg_latch = ss_ppu.vram_bg_latch;
   dma3_video_transfer_running = ss_ppu.dma3_video_transfer_running;
+
+  // The composition state of the current frame is not part of the save state.
+  skipped_composition = false;
 }
 
 void PPU::CopyState(SaveState& state) {
@@ -113,12 +110,26 @@ void PPU::CopyState(SaveState& state) {
   ss_ppu.io.bldalpha = mmio.eva | (mmio.evb << 8);
   ss_ppu.io.bldy = mmio.evy;
 
-  std::memcpy(state.bus.memory.pram, pram, 0x400);
-  std::memcpy(state.bus.memory.oam,  oam,  0x400);
-  std::memcpy(state.bus.memory.vram, vram, 0x18000);
-
   ss_ppu.vram_bg_latch = vram_bg_latch;
   ss_ppu.dma3_video_transfer_running = dma3_video_transfer_running;
 }
 
+void PPU::LoadMemory(Snapshot::Memory& memory, bool swap) {
+  if(swap) {
+    pram.swap(memory.pram);
+    oam.swap(memory.oam);
+    vram.swap(memory.vram);
+  } else {
+    pram = memory.pram;
+    oam  = memory.oam;
+    vram = memory.vram;
+  }
+}
+
+void PPU::CopyMemory(Snapshot::Memory& memory) {
+  memory.pram = pram;
+  memory.oam  = oam;
+  memory.vram = vram;
+}
+
 } // namespace nba::core
\ No newline at end of file
@@ -5,6 +5,8 @@
  * Refer to the included LICENSE file.
  */
 
+#include <algorithm>
+
 #include "ppu.hpp"
 
 namespace nba::core {
@@ -26,6 +28,28 @@ void PPU::InitWindow() {
 
   window.timestamp_last_sync = scheduler.GetTimestampNow();
   window.cycle = 0;
+
+  /* The buffer only needs to be rewritten if this scanline's inputs differ from those of the scanline in the buffer.
+   * The buffer is not read during V-blank, so it is not updated there at all.
+   */
+  window.line_key = GetWindowKey();
+  window.line_fill = vcount < 160 && window.line_key != window.buffer_key;
+  window.line_partial = false;
+
+  if(window.line_fill) {
+    window.buffer_key = ~0ULL;
+  }
+}
+
+auto PPU::GetWindowKey() const -> u64 {
+  u64 key = 0U;
+
+  for(int i = 0; i < 2; i++) {
+    key |= (u64)((mmio.winh[i].min << 8) | mmio.winh[i].max) << (i * 16);
+    key |= (u64)((window.v_flag[i] << 1) | window.h_flag[i]) << (32 + i * 2);
+  }
+
+  return key;
 }
 
 void PPU::DrawWindow() {
@@ -37,30 +61,79 @@ void PPU::DrawWindow() {
     return;
   }
 
-  for(int i = 0; i < cycles; i++) {
-    if((window.cycle & 3U) == 0U) {
-      const uint x = window.cycle >> 2;
+  // WINxH was written since the start of the scanline, the remaining part must be rendered.
+  if((u32)window.line_key != (u32)GetWindowKey()) {
+    window.line_key = ~0ULL;
+
+    if(mmio.vcount < 160) {
+      window.line_fill = true;
+      window.buffer_key = ~0ULL;
+    }
+  }
 
-      for(int i = 0; i < 2; i++) {
-        const auto& winh = mmio.winh[i];
+  // The horizontal flags are evaluated every four cycles, for X = 0 to 255.
+  const uint cycle_end = std::min(window.cycle + (uint)cycles, 1024U);
+  const uint x_begin = (window.cycle + 3U) >> 2;
+  const uint x_end = (cycle_end + 3U) >> 2;
 
-        if(x == winh.min) {
-          window.h_flag[i] = true;
-        }
+  /* The buffer is only read while WIN0 or WIN1 are enabled (OBJWIN uses the sprite buffer), so it is not written otherwise.
+   * Merge trails the window by 46 cycles, so the last 12 pixels are still written in case a window gets enabled before merge reaches them.
+   * The flags are evaluated regardless, since they must be correct once a window is enabled.
+   */
+  uint x_fill_begin = x_begin;
 
-        if(x == winh.max) {
-          window.h_flag[i] = false;
-        }
+  if(window.line_fill && !mmio.dispcnt.enable[ENABLE_WIN0] && !mmio.dispcnt.enable[ENABLE_WIN1]) {
+    x_fill_begin = std::max(x_begin, x_end - std::min(x_end, 12U));
+    window.line_partial |= x_fill_begin != x_begin;
+  }
 
-        if(x < 240) {
-          window.buffer[x][i] = window.h_flag[i] && window.v_flag[i];
+  for(int i = 0; i < 2; i++) {
+    const uint min = (uint)mmio.winh[i].min;
+    const uint max = (uint)mmio.winh[i].max;
+    const bool v_flag = window.v_flag[i];
+
+    bool h_flag = window.h_flag[i];
+    uint x = x_begin;
+
+    const auto Fill = [&](uint x_fill_end) {
+      if(window.line_fill) {
+        x_fill_end = std::min(x_fill_end, 240U);
+
+        for(uint fill_x = std::max(x, x_fill_begin); fill_x < x_fill_end; fill_x++) {
+          window.buffer[fill_x][i] = h_flag && v_flag;
         }
       }
-    }
+    };
+
+    while(x < x_end) {
+      // The flag can only change at the left and right edge.
+      uint x_next = x_end;
+
+      if(min >= x && min < x_next) x_next = min;
+      if(max >= x && max < x_next) x_next = max;
+
+      Fill(x_next);
 
-    if(++window.cycle == 1024U) {
-      break;
+      x = x_next;
+
+      if(x == x_end) {
+        break;
+      }
+
+      if(x == min) h_flag = true;
+      if(x == max) h_flag = false;
+
+      Fill(x + 1U);
+      x++;
     }
+
+    window.h_flag[i] = h_flag;
+  }
+
+  window.cycle = cycle_end;
+
+  if(window.cycle == 1024U && window.line_fill && !window.line_partial) {
+    window.buffer_key = window.line_key;
   }
 
   window.timestamp_last_sync = timestamp_now;
@@ -29,11 +29,29 @@ void Timer::LoadState(SaveState const& state) {
     channels[i].shift = g_ticks_shift[channels[i].control.frequency];
     channels[i].mask = g_ticks_mask[channels[i].control.frequency];
 
-    channels[i].running = false;
     channels[i].event_overflow = scheduler.GetEventByUID(state.timer[i].event_uid);
+    channels[i].running = channels[i].event_overflow != nullptr;
+    channels[i].batch = 1;
 
     channels[i].pending.reload = state.timer[i].pending.reload;
     channels[i].pending.control = state.timer[i].pending.control;
+
+    if(channels[i].running) {
+      const u64 timestamp_now = scheduler.GetTimestampNow();
+      const u64 timestamp_overflow = channels[i].event_overflow->timestamp;
+
+      // The counter was saved for the current cycle, recover the prescaler phase from the overflow event.
+      channels[i].timestamp_started = timestamp_now - ((timestamp_now - timestamp_overflow) & channels[i].mask);
+
+      // The overflow event may stand in for several coalesced overflows.
+      const u64 timestamp_first = channels[i].timestamp_started + ((u64)(0x10000 - channels[i].counter) << channels[i].shift);
+
+      if(timestamp_overflow > timestamp_first) {
+        const u64 period = (u64)(0x10000 - channels[i].reload) << channels[i].shift;
+
+        channels[i].batch += (int)((timestamp_overflow - timestamp_first) / period);
+      }
+    }
   }
 }
 
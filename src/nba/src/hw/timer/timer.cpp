@@ -13,6 +13,7 @@ namespace nba::core {
 
 static constexpr int g_ticks_shift[4] = { 0, 6, 8, 10 };
 static constexpr int g_ticks_mask[4] = { 0, 0x3F, 0xFF, 0x3FF };
+static constexpr int g_max_overflow_batch = 0x10000;
 
 Timer::Timer(Scheduler& scheduler, IRQ& irq, APU& apu)
     : scheduler(scheduler)
@@ -119,6 +120,16 @@ auto Timer::ReadCounter(Channel const& channel) -> u16 {
   // While the timer is still running we must account for time that has passed
   // since the last counter update (overflow or configuration change).
   if(channel.running) {
+    const int overflows = GetDueOverflows(channel);
+
+    if(overflows > 0) {
+      // The counter has been reloaded by an overflow which has not been applied yet.
+      const u64 cycles = scheduler.GetTimestampNow() - channel.timestamp_started -
+        ((u64)(0x10000 - channel.counter) << channel.shift) - (overflows - 1) * GetOverflowPeriod(channel);
+
+      return channel.reload + (cycles >> channel.shift);
+    }
+
     counter += GetCounterDeltaSinceLastUpdate(channel);
   }
 
@@ -146,8 +157,29 @@ void Timer::WriteControl(Channel& channel, u16 value) {
   scheduler.Add(1, Scheduler::EventClass::TM_write_control, 2, channel.id);
 }
 
+void Timer::SyncFIFOTimers() {
+  SyncOverflows(channels[0]);
+  SyncOverflows(channels[1]);
+}
+
+void Timer::RescheduleFIFOTimers() {
+  RescheduleOverflow(channels[0]);
+  RescheduleOverflow(channels[1]);
+}
+
 void Timer::OnReloadWritten(u64 chan_id) {
-  channels[chan_id].reload = channels[chan_id].pending.reload;
+  auto& channel = channels[chan_id];
+
+  if(channel.batch > 1) {
+    // The coalesced overflows were scheduled using the old reload value.
+    const int cycle_offset = (scheduler.GetTimestampNow() - channel.timestamp_started) & channel.mask;
+
+    StopChannel(channel);
+    channel.reload = channel.pending.reload;
+    StartChannel(channel, cycle_offset);
+  } else {
+    channel.reload = channel.pending.reload;
+  }
 }
 
 void Timer::OnControlWritten(u64 chan_id) {
@@ -196,14 +228,95 @@ void Timer::OnControlWritten(u64 chan_id) {
       }
     }
   }
+
+  // The previous timer may not coalesce its overflows anymore, if this timer now counts them.
+  if(channel.id != 0) {
+    RescheduleOverflow(channels[channel.id - 1]);
+  }
 }
 
 auto Timer::GetCounterDeltaSinceLastUpdate(Channel const& channel) -> u32 {
   return (scheduler.GetTimestampNow() - channel.timestamp_started) >> channel.shift;
 }
 
+auto Timer::GetOverflowPeriod(Channel const& channel) -> u64 {
+  return (u64)(0x10000 - channel.reload) << channel.shift;
+}
+
+auto Timer::GetOverflowBatchSize(Channel const& channel) -> int {
+  if(channel.control.interrupt) {
+    return 1;
+  }
+
+  if(channel.id != 3) {
+    auto const& next_channel = channels[channel.id + 1];
+
+    if(next_channel.control.enable && next_channel.control.cascade) {
+      return 1;
+    }
+  }
+
+  if(channel.id <= 1) {
+    return std::min(apu.GetLazyOverflowLimit(channel.id), g_max_overflow_batch - 1) + 1;
+  }
+
+  return g_max_overflow_batch;
+}
+
+auto Timer::GetDueOverflows(Channel const& channel) -> int {
+  const u64 timestamp_now = scheduler.GetTimestampNow();
+
+  if(channel.batch <= 1 || timestamp_now < channel.timestamp_started) {
+    return 0;
+  }
+
+  const u64 cycles = timestamp_now - channel.timestamp_started;
+  const u64 cycles_first = (u64)(0x10000 - channel.counter) << channel.shift;
+
+  if(cycles < cycles_first) {
+    return 0;
+  }
+
+  // The last overflow of the batch always is handled by the overflow event.
+  return (int)std::min<u64>((cycles - cycles_first) / GetOverflowPeriod(channel) + 1, channel.batch - 1);
+}
+
+void Timer::SyncOverflows(Channel& channel) {
+  const int overflows = GetDueOverflows(channel);
+
+  if(overflows == 0) {
+    return;
+  }
+
+  channel.timestamp_started += ((u64)(0x10000 - channel.counter) << channel.shift) + (overflows - 1) * GetOverflowPeriod(channel);
+  channel.counter = channel.reload;
+  channel.batch -= overflows;
+
+  if(channel.id <= 1) {
+    apu.OnTimerOverflow(channel.id, overflows);
+  }
+}
+
+void Timer::RescheduleOverflow(Channel& channel) {
+  SyncOverflows(channel);
+
+  // Restart the channel if one of the coalesced overflows must be handled on time now.
+  if(channel.batch > 1 && channel.batch > GetOverflowBatchSize(channel)) {
+    const int cycle_offset = (scheduler.GetTimestampNow() - channel.timestamp_started) & channel.mask;
+
+    StopChannel(channel);
+    StartChannel(channel, cycle_offset);
+  }
+}
+
 void Timer::StartChannel(Channel& channel, int cycle_offset) {
-  int cycles = int((0x10000 - channel.counter) << channel.shift) - cycle_offset;
+  u64 cycles = (u64)((0x10000 - channel.counter) << channel.shift) - cycle_offset;
+
+  channel.batch = GetOverflowBatchSize(channel);
+
+  if(channel.batch > 1) {
+    cycles += (channel.batch - 1) * GetOverflowPeriod(channel);
+  }
 
   channel.running = true;
   channel.timestamp_started = scheduler.GetTimestampNow() - cycle_offset;
@@ -211,6 +324,8 @@ void Timer::StartChannel(Channel& channel, int cycle_offset) {
 }
 
 void Timer::StopChannel(Channel& channel) {
+  SyncOverflows(channel);
+
   channel.counter += GetCounterDeltaSinceLastUpdate(channel);
   if(channel.counter >= 0x10000) {
     ReloadCascadeAndRequestIRQ(channel);
@@ -219,6 +334,7 @@ void Timer::StopChannel(Channel& channel) {
   scheduler.Cancel(channel.event_overflow);
   channel.event_overflow = nullptr;
   channel.running = false;
+  channel.batch = 1;
 }
 
 void Timer::ReloadCascadeAndRequestIRQ(Channel& channel) {
@@ -243,6 +359,7 @@ void Timer::ReloadCascadeAndRequestIRQ(Channel& channel) {
 void Timer::OnOverflow(u64 chan_id) {
   auto& channel = channels[chan_id];
 
+  SyncOverflows(channel);
   ReloadCascadeAndRequestIRQ(channel);
   StartChannel(channel, 0);
 }
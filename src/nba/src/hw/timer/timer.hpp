@@ -28,6 +28,14 @@ struct Timer {
   void WriteHalf(int chan_id, int offset, u16 value);
   void WriteWord(int chan_id, u32 value);
 
+  /**
+   * Overflows of timers that neither request an IRQ nor clock a cascaded timer are coalesced into a single event.
+   * For timers 0 and 1 this is limited to overflows which do not request a FIFO DMA,
+   * their effect on the FIFOs is applied lazily whenever the FIFO state is accessed.
+   */
+  void SyncFIFOTimers();
+  void RescheduleFIFOTimers();
+
   void LoadState(SaveState const& state);
   void CopyState(SaveState& state);
 
@@ -60,6 +68,9 @@ private:
     int samplerate;
     u64 timestamp_started;
     Scheduler::Event* event_overflow = nullptr;
+
+    // Number of overflows until and including the one signalled by event_overflow.
+    int batch = 1;
   } channels[4];
 
   Scheduler& scheduler;
@@ -76,6 +87,11 @@ private:
   void OnControlWritten(u64 chan_id);
 
   auto GetCounterDeltaSinceLastUpdate(Channel const& channel) -> u32;
+  auto GetOverflowPeriod(Channel const& channel) -> u64;
+  auto GetOverflowBatchSize(Channel const& channel) -> int;
+  auto GetDueOverflows(Channel const& channel) -> int;
+  void SyncOverflows(Channel& channel);
+  void RescheduleOverflow(Channel& channel);
   void StartChannel(Channel& channel, int cycle_offset);
   void StopChannel(Channel& channel);
   void ReloadCascadeAndRequestIRQ(Channel& channel);
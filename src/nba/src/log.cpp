@@ -0,0 +1,233 @@
+/*
+ * Copyright (C) 2024 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <nba/log.hpp>
+#include <nba/integer.hpp>
+#include <thread>
+
+namespace nba {
+
+namespace detail {
+
+std::atomic<int> g_log_mask = kLogMask;
+
+static auto GetLevelStyle(Level level) -> std::pair<fmt::text_style, char const*> {
+  switch(level) {
+    case Trace: return {fmt::fg(fmt::terminal_color::cyan),    "[T]"};
+    case Debug: return {fmt::fg(fmt::terminal_color::blue),    "[D]"};
+    case Info:  return {fmt::text_style{},                     "[I]"};
+    case Warn:  return {fmt::fg(fmt::terminal_color::yellow),  "[W]"};
+    case Error: return {fmt::fg(fmt::terminal_color::magenta), "[E]"};
+    case Fatal: return {fmt::fg(fmt::terminal_color::red),     "[F]"};
+    default:    return {fmt::text_style{},                     "[?]"};
+  }
+}
+
+static void Write(Level level, std::string_view message) {
+  const auto [style, prefix] = GetLevelStyle(level);
+
+  fmt::print(style, "{} {}\n", prefix, message);
+}
+
+/**
+ * Bounded multi-producer single-consumer queue (based on Dmitry Vyukov's bounded MPMC queue).
+ * Producers never block: if the queue is full the record is dropped and counted.
+ */
+struct LogBackend {
+  static constexpr size_t kCapacity = 1024;
+
+  LogBackend() {
+    for(size_t i = 0; i < kCapacity; i++) {
+      slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    thread = std::thread{[this]() { ThreadMain(); }};
+  }
+
+ ~LogBackend() {
+    running = false;
+    cv.notify_one();
+    thread.join();
+  }
+
+  void Push(LogRecord const& record) {
+    u64 position = head.load(std::memory_order_relaxed);
+
+    while(true) {
+      auto& slot = slots[position % kCapacity];
+      const u64 sequence = slot.sequence.load(std::memory_order_acquire);
+      const s64 difference = (s64)sequence - (s64)position;
+
+      if(difference == 0) {
+        if(head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          slot.record = record;
+          slot.sequence.store(position + 1, std::memory_order_release);
+          break;
+        }
+      } else if(difference < 0) {
+        drop_count.fetch_add(1, std::memory_order_relaxed);
+        return;
+      } else {
+        position = head.load(std::memory_order_relaxed);
+      }
+    }
+
+    cv.notify_one();
+  }
+
+  void Flush() {
+    // Give up after a while in case the writer thread is not running anymore (i.e. during shutdown).
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{1};
+
+    while(written.load(std::memory_order_acquire) != head.load(std::memory_order_acquire) &&
+          std::this_thread::get_id() != thread.get_id() &&
+          std::chrono::steady_clock::now() < deadline) {
+      cv.notify_one();
+      std::this_thread::yield();
+    }
+
+    std::fflush(stdout);
+  }
+
+private:
+  struct Slot {
+    std::atomic<u64> sequence;
+    LogRecord record;
+  };
+
+  auto Pop(LogRecord& record) -> bool {
+    auto& slot = slots[tail % kCapacity];
+
+    if(slot.sequence.load(std::memory_order_acquire) != tail + 1) {
+      return false;
+    }
+
+    record = slot.record;
+    slot.sequence.store(tail + kCapacity, std::memory_order_release);
+    tail++;
+    return true;
+  }
+
+  void ThreadMain() {
+    LogRecord record;
+    fmt::memory_buffer buffer;
+
+    while(true) {
+      bool did_write = false;
+
+      while(Pop(record)) {
+        if(record.format_fn) {
+          buffer.clear();
+          record.format_fn(buffer, {&record.data[record.size], record.format_size}, record.data);
+          Write(record.level, {buffer.data(), buffer.size()});
+        } else {
+          Write(record.level, {record.data, record.size});
+        }
+        written.fetch_add(1, std::memory_order_release);
+        did_write = true;
+      }
+
+      const u64 dropped = drop_count.exchange(0, std::memory_order_relaxed);
+
+      if(dropped != 0) {
+        Write(Warn, fmt::format("Log: dropped {} message(s) because the log queue was full", dropped));
+      }
+
+      if(did_write) {
+        std::fflush(stdout);
+      }
+
+      if(!running && written.load(std::memory_order_relaxed) == head.load(std::memory_order_acquire)) {
+        break;
+      }
+
+      // Producers notify without holding the mutex, so a notification may be missed. The timeout covers for that.
+      std::unique_lock lock{mutex};
+      cv.wait_for(lock, std::chrono::milliseconds{10});
+    }
+  }
+
+  Slot slots[kCapacity];
+  alignas(64) std::atomic<u64> head = 0;
+  alignas(64) u64 tail = 0;
+  std::atomic<u64> written = 0;
+  std::atomic<u64> drop_count = 0;
+  std::atomic<bool> running = true;
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::thread thread;
+};
+
+static auto GetLogBackend() -> LogBackend& {
+  static LogBackend backend{};
+  return backend;
+}
+
+bool LogShouldRateLimit(char const* site) {
+  static constexpr int kTableSize = 256;
+  static constexpr u32 kMaxMessagesPerSecond = 100;
+
+  struct Entry {
+    std::atomic<char const*> site;
+    std::atomic<u64> second;
+    std::atomic<u32> count;
+    std::atomic<u32> suppressed;
+  };
+
+  static Entry table[kTableSize];
+
+  auto& entry = table[((uintptr_t)site >> 2) % kTableSize];
+  char const* expected = nullptr;
+
+  if(!entry.site.compare_exchange_strong(expected, site, std::memory_order_relaxed) && expected != site) {
+    // Slot is owned by a different message site, do not rate limit this one.
+    return false;
+  }
+
+  const u64 second = (u64)std::chrono::duration_cast<std::chrono::seconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+
+  if(entry.second.exchange(second, std::memory_order_relaxed) != second) {
+    const u32 suppressed = entry.suppressed.exchange(0, std::memory_order_relaxed);
+
+    entry.count.store(0, std::memory_order_relaxed);
+
+    if(suppressed != 0) {
+      Log<Warn>("Log: suppressed {} message(s) like: {}", suppressed, site);
+    }
+  }
+
+  if(entry.count.fetch_add(1, std::memory_order_relaxed) >= kMaxMessagesPerSecond) {
+    entry.suppressed.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  return false;
+}
+
+void LogPush(LogRecord const& record) {
+  GetLogBackend().Push(record);
+}
+
+void LogWriteSync(Level level, std::string_view message) {
+  FlushLog();
+  Write(level, message);
+  std::fflush(stdout);
+}
+
+} // namespace nba::detail
+
+void FlushLog() {
+  detail::GetLogBackend().Flush();
+}
+
+} // namespace nba
@@ -0,0 +1,239 @@
+/*
+ * Copyright (C) 2024 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <nba/common/crc32.hpp>
+#include <nba/log.hpp>
+#include <nba/movie.hpp>
+
+namespace nba {
+
+template<typename T>
+static void Put(std::vector<u8>& data, T value) {
+  for(size_t i = 0; i < sizeof(T); i++) {
+    data.push_back((u8)(value >> (i * 8)));
+  }
+}
+
+template<typename T>
+static bool Get(std::vector<u8> const& data, size_t& offset, T& value) {
+  if(data.size() - offset < sizeof(T)) {
+    return false;
+  }
+
+  value = 0;
+  for(size_t i = 0; i < sizeof(T); i++) {
+    value |= (T)data[offset++] << (i * 8);
+  }
+  return true;
+}
+
+void InputMovie::Encode(std::vector<u8>& data) const {
+  data.clear();
+
+  Put<u32>(data, kMagicNumber);
+  Put<u32>(data, kCurrentVersion);
+  Put<u32>(data, rom_crc32);
+  Put<u32>(data, bios_crc32);
+  Put<u64>(data, start_timestamp);
+  Put<u64>(data, length);
+  Put<u32>(data, save_state ? kFlagSaveState : 0);
+  Put<u32>(data, (u32)events.size());
+
+  if(save_state) {
+    auto raw = (u8 const*)save_state.get();
+    data.insert(data.end(), raw, raw + sizeof(SaveState));
+  }
+
+  u64 timestamp = start_timestamp;
+
+  for(auto const& event : events) {
+    // The delta encoding cannot represent events which go back in time.
+    Assert(event.timestamp >= timestamp, "InputMovie: event timestamps must not decrease");
+
+    u64 delta = event.timestamp - timestamp;
+
+    do {
+      data.push_back((u8)(delta & 0x7F) | (delta > 0x7F ? 0x80 : 0));
+      delta >>= 7;
+    } while(delta != 0);
+
+    data.push_back((u8)event.key | (event.pressed ? 0x80 : 0));
+    timestamp = event.timestamp;
+  }
+}
+
+auto InputMovie::Decode(std::vector<u8> const& data) -> Result {
+  size_t offset = 0;
+  u32 magic;
+  u32 version;
+  u32 flags;
+  u32 event_count;
+
+  if(!Get(data, offset, magic) || magic != kMagicNumber) {
+    return Result::BadImage;
+  }
+
+  if(!Get(data, offset, version) || version != kCurrentVersion) {
+    return Result::UnsupportedVersion;
+  }
+
+  if(!Get(data, offset, rom_crc32) ||
+     !Get(data, offset, bios_crc32) ||
+     !Get(data, offset, start_timestamp) ||
+     !Get(data, offset, length) ||
+     !Get(data, offset, flags) ||
+     !Get(data, offset, event_count)) {
+    return Result::BadImage;
+  }
+
+  save_state.reset();
+
+  if(flags & kFlagSaveState) {
+    if(data.size() - offset < sizeof(SaveState)) {
+      return Result::BadImage;
+    }
+
+    save_state = std::make_unique<SaveState>();
+    std::memcpy(save_state.get(), &data[offset], sizeof(SaveState));
+    offset += sizeof(SaveState);
+
+    // Movies recorded before the HLE section was added embed version 10 save states.
+    UpgradeSaveState(*save_state);
+  }
+
+  u64 timestamp = start_timestamp;
+
+  events.clear();
+  events.reserve(event_count);
+
+  for(u32 i = 0; i < event_count; i++) {
+    u64 delta = 0;
+    int shift = 0;
+    u8 byte;
+
+    do {
+      if(offset == data.size() || shift >= 64) {
+        return Result::BadImage;
+      }
+      byte = data[offset++];
+      delta |= (u64)(byte & 0x7F) << shift;
+      shift += 7;
+    } while(byte & 0x80);
+
+    if(offset == data.size()) {
+      return Result::BadImage;
+    }
+
+    byte = data[offset++];
+
+    if((byte & 0x7F) >= (u8)Key::Count) {
+      return Result::BadImage;
+    }
+
+    timestamp += delta;
+    events.push_back({timestamp, (Key)(byte & 0x7F), (byte & 0x80) != 0});
+  }
+
+  return Result::Success;
+}
+
+auto InputMovie::CalculateCRC32(std::vector<u8> const& data) -> u32 {
+  return crc32(data.data(), (int)data.size());
+}
+
+void MovieRecorder::Start(CoreBase& core, std::vector<u8> const& bios, bool from_save_state) {
+  if(from_save_state) {
+    movie.save_state = std::make_unique<SaveState>();
+    core.CopyState(*movie.save_state);
+  } else {
+    movie.save_state.reset();
+    core.Reset();
+  }
+
+  movie.rom_crc32 = InputMovie::CalculateCRC32(core.GetROM().GetRawROM());
+  movie.bios_crc32 = InputMovie::CalculateCRC32(bios);
+  movie.start_timestamp = core.GetScheduler().GetTimestampNow();
+  movie.length = 0;
+  movie.events.clear();
+  recording = true;
+}
+
+void MovieRecorder::SetKeyStatus(CoreBase& core, Key key, bool pressed) {
+  if(recording) {
+    movie.events.push_back({core.GetScheduler().GetTimestampNow(), key, pressed});
+  }
+
+  core.SetKeyStatus(key, pressed);
+}
+
+auto MovieRecorder::Stop(CoreBase& core) -> InputMovie& {
+  if(recording) {
+    movie.length = core.GetScheduler().GetTimestampNow() - movie.start_timestamp;
+    recording = false;
+  }
+
+  return movie;
+}
+
+auto MoviePlayer::Start(CoreBase& core, InputMovie const& movie, std::vector<u8> const& bios) -> Result {
+  if(InputMovie::CalculateCRC32(core.GetROM().GetRawROM()) != movie.rom_crc32) {
+    return Result::ROMMismatch;
+  }
+
+  if(InputMovie::CalculateCRC32(bios) != movie.bios_crc32) {
+    return Result::BIOSMismatch;
+  }
+
+  if(movie.save_state) {
+    core.LoadState(*movie.save_state);
+  } else {
+    core.Reset();
+  }
+
+  this->movie = &movie;
+  next_event = 0;
+  return Result::Success;
+}
+
+void MoviePlayer::Run(CoreBase& core, int cycles) {
+  if(movie == nullptr) {
+    return;
+  }
+
+  auto& scheduler = core.GetScheduler();
+  auto const& events = movie->events;
+  const u64 limit = std::min(scheduler.GetTimestampNow() + cycles, movie->start_timestamp + movie->length);
+
+  while(true) {
+    const u64 timestamp_now = scheduler.GetTimestampNow();
+
+    while(next_event < events.size() && events[next_event].timestamp <= timestamp_now) {
+      core.SetKeyStatus(events[next_event].key, events[next_event].pressed);
+      next_event++;
+    }
+
+    if(timestamp_now >= limit) {
+      break;
+    }
+
+    u64 timestamp_target = limit;
+
+    if(next_event < events.size()) {
+      timestamp_target = std::min(timestamp_target, events[next_event].timestamp);
+    }
+
+    core.Run((int)(timestamp_target - timestamp_now));
+  }
+}
+
+bool MoviePlayer::IsFinished(CoreBase& core) const {
+  return movie == nullptr || core.GetScheduler().GetTimestampNow() >= movie->start_timestamp + movie->length;
+}
+
+} // namespace nba
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2024 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <algorithm>
+#include <fmt/format.h>
+#include <nba/profiler.hpp>
+
+namespace nba {
+
+template<typename Map>
+static auto SortByCount(Map const& map) {
+  std::vector<std::pair<typename Map::key_type, u64>> entries{map.begin(), map.end()};
+
+  std::sort(entries.begin(), entries.end(), [](auto const& a, auto const& b) {
+    return a.second > b.second || (a.second == b.second && a.first < b.first);
+  });
+  return entries;
+}
+
+void Profiler::Reset() {
+  timestamp_next_sample = 0;
+  sample_count = 0;
+  stack.clear();
+  histogram.clear();
+  call_edges.clear();
+  stacks.clear();
+}
+
+void Profiler::OnCall(u32 function, u32 return_address) {
+  const u32 caller = stack.empty() ? 0xFFFFFFFF : stack.back().function;
+
+  call_edges[(u64)caller << 32 | function]++;
+
+  // Guest code that never returns (or returns in a way that we fail to track) would grow the stack forever.
+  if(stack.size() == kMaxStackDepth) {
+    stack.erase(stack.begin());
+  }
+
+  stack.push_back({function, return_address});
+}
+
+void Profiler::OnBranch(u32 address) {
+  // Unwind to the frame that the branch returns from (if any), this also takes care of frames which were left via longjmp() or similar.
+  for(int i = (int)stack.size() - 1; i >= 0; i--) {
+    if(stack[i].return_address == address) {
+      stack.resize(i);
+      break;
+    }
+  }
+}
+
+void Profiler::Record(u32 address) {
+  std::vector<u32> functions{};
+
+  functions.reserve(stack.size());
+
+  for(auto const& frame : stack) {
+    functions.push_back(frame.function);
+  }
+
+  histogram[address]++;
+  stacks[std::move(functions)]++;
+  sample_count++;
+}
+
+void Profiler::WriteHistogram(std::ostream& stream) const {
+  for(auto const& [address, count] : SortByCount(histogram)) {
+    stream << fmt::format("{:08X} {} {:.2f}%\n", address, count, count * 100.0 / sample_count);
+  }
+}
+
+void Profiler::WriteCallGraph(std::ostream& stream) const {
+  for(auto const& [edge, count] : SortByCount(call_edges)) {
+    const u32 caller = (u32)(edge >> 32);
+    const u32 callee = (u32)edge;
+
+    if(caller == 0xFFFFFFFF) {
+      stream << fmt::format("[root] -> {:08X} {}\n", callee, count);
+    } else {
+      stream << fmt::format("{:08X} -> {:08X} {}\n", caller, callee, count);
+    }
+  }
+}
+
+void Profiler::WriteCollapsedStacks(std::ostream& stream) const {
+  for(auto const& [functions, count] : stacks) {
+    stream << "[root]";
+    for(u32 function : functions) {
+      stream << fmt::format(";{:08X}", function);
+    }
+    stream << ' ' << count << '\n';
+  }
+}
+
+} // namespace nba
@@ -10,6 +10,63 @@
 namespace nba::core {
 
 void Core::LoadState(SaveState const& state) {
+  auto& memory = state.bus.memory;
+
+  bus.memory.wram.Load(memory.wram.data());
+  bus.memory.iram.Load(memory.iram.data());
+  ppu.GetPRAMBlock().Load(memory.pram);
+  ppu.GetOAMBlock().Load(memory.oam);
+  ppu.GetVRAMBlock().Load(memory.vram);
+
+  LoadStateExceptMemory(state);
+}
+
+void Core::CopyState(SaveState& state) {
+  auto& memory = state.bus.memory;
+
+  CopyStateExceptMemory(state);
+
+  bus.memory.wram.Store(memory.wram.data());
+  bus.memory.iram.Store(memory.iram.data());
+  ppu.GetPRAMBlock().Store(memory.pram);
+  ppu.GetOAMBlock().Store(memory.oam);
+  ppu.GetVRAMBlock().Store(memory.vram);
+}
+
+auto Core::CreateSnapshot() -> SnapshotHandle {
+  auto snapshot = std::move(spare_snapshot);
+
+  if(!snapshot) {
+    // Default-initialize, so that the unused memory arrays of the save state are never touched.
+    snapshot.reset(new Snapshot);
+  }
+
+  CopySnapshot(*snapshot);
+  return snapshot;
+}
+
+void Core::CopySnapshot(Snapshot& snapshot) {
+  CopyStateExceptMemory(snapshot.state);
+
+  bus.CopyMemory(snapshot.memory);
+  ppu.CopyMemory(snapshot.memory);
+}
+
+void Core::LoadSnapshot(SnapshotHandle snapshot) {
+  // Nobody else can observe the snapshot, so we may swap its memories with ours.
+  const bool swap = snapshot.use_count() == 1;
+
+  bus.LoadMemory(snapshot->memory, swap);
+  ppu.LoadMemory(snapshot->memory, swap);
+
+  LoadStateExceptMemory(snapshot->state);
+
+  if(swap) {
+    spare_snapshot = std::move(snapshot);
+  }
+}
+
+void Core::LoadStateExceptMemory(SaveState const& state) {
   scheduler.Reset();
   scheduler.SetTimestampNow(state.timestamp);
 
@@ -22,9 +79,10 @@ void Core::LoadState(SaveState const& state) {
   timer.LoadState(state);
   dma.LoadState(state);
   keypad.LoadState(state);
+  bios_hle.LoadState(state);
 }
 
-void Core::CopyState(SaveState& state) {
+void Core::CopyStateExceptMemory(SaveState& state) {
   state.magic = SaveState::kMagicNumber;
   state.version = SaveState::kCurrentVersion;
   state.timestamp = scheduler.GetTimestampNow();
@@ -38,6 +96,7 @@ void Core::CopyState(SaveState& state) {
   timer.CopyState(state);
   dma.CopyState(state);
   keypad.CopyState(state);
+  bios_hle.CopyState(state);
 }
 
 } // namespace nba::core
\ No newline at end of file
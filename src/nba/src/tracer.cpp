@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2024 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <fmt/format.h>
+#include <iterator>
+#include <nba/log.hpp>
+#include <nba/scheduler.hpp>
+#include <nba/tracer.hpp>
+
+namespace nba {
+
+static constexpr const char* kEventClassNames[] {
+  "ARM_ldm_usermode_conflict",
+  "PPU_hdraw_vdraw",
+  "PPU_hblank_vdraw",
+  "PPU_hdraw_vblank",
+  "PPU_hblank_vblank",
+  "PPU_begin_sprite_fetch",
+  "PPU_update_vcount_flag",
+  "PPU_video_dma",
+  "PPU_latch_dispcnt",
+  "PPU_hblank_irq",
+  "PPU_vblank_irq",
+  "PPU_vcount_irq",
+  "APU_mixer",
+  "APU_sequencer",
+  "APU_PSG1_generate",
+  "APU_PSG2_generate",
+  "APU_PSG3_generate",
+  "APU_PSG4_generate",
+  "IRQ_write_io",
+  "IRQ_update_ie_and_if",
+  "IRQ_update_irq_line",
+  "TM_overflow",
+  "TM_write_reload",
+  "TM_write_control",
+  "DMA_activated",
+  "EEPROM_ready",
+  "SIO_transfer_done",
+  "EndOfQueue"
+};
+
+static_assert(std::size(kEventClassNames) == (size_t)core::Scheduler::EventClass::Count);
+
+static constexpr const char* kIRQNames[] {
+  "VBlank", "HBlank", "VCount",
+  "Timer 0", "Timer 1", "Timer 2", "Timer 3",
+  "Serial",
+  "DMA 0", "DMA 1", "DMA 2", "DMA 3",
+  "Keypad", "ROM"
+};
+
+Tracer::Tracer(size_t capacity)
+    : buffer(capacity)
+    , mask(capacity - 1)
+    , host_time_base(std::chrono::steady_clock::now()) {
+  Assert(capacity != 0 && (capacity & (capacity - 1)) == 0, "Tracer: capacity must be a power of two.");
+}
+
+auto Tracer::Read(std::vector<Record>& records) -> size_t {
+  const u64 tail = this->tail.load(std::memory_order_relaxed);
+  const u64 head = this->head.load(std::memory_order_acquire);
+
+  for(u64 i = tail; i != head; i++) {
+    records.push_back(buffer[i & mask]);
+  }
+
+  this->tail.store(head, std::memory_order_release);
+  return (size_t)(head - tail);
+}
+
+void Tracer::WriteChromeTrace(std::ostream& stream, std::vector<Record> const& records) {
+  enum Thread {
+    ThreadCPU,
+    ThreadScheduler,
+    ThreadDMA,
+    ThreadIRQ
+  };
+
+  // Chrome trace timestamps are given in microseconds.
+  const auto us = [](u64 ns) { return ns / 1000.0; };
+
+  stream << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+
+  const char* thread_names[] { "CPU", "Scheduler", "DMA", "IRQ" };
+
+  for(int tid = 0; tid < (int)std::size(thread_names); tid++) {
+    stream << fmt::format(
+      "{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":{},\"args\":{{\"name\":\"{}\"}}}},\n", tid, thread_names[tid]);
+  }
+
+  for(auto const& record : records) {
+    switch(record.type) {
+      case Type::Event: {
+        const char* name = record.arg < std::size(kEventClassNames) ? kEventClassNames[record.arg] : "?";
+
+        stream << fmt::format(
+          "{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":0,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f},\"args\":{{\"cycle\":{}}}}},\n",
+          name, (int)ThreadScheduler, us(record.host_time), us(record.host_duration), record.timestamp);
+        break;
+      }
+      case Type::DMA: {
+        stream << fmt::format(
+          "{{\"name\":\"DMA{}\",\"ph\":\"X\",\"pid\":0,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f},\"args\":{{\"cycle\":{}}}}},\n",
+          record.arg, (int)ThreadDMA, us(record.host_time), us(record.host_duration), record.timestamp);
+        break;
+      }
+      case Type::IRQ: {
+        const char* name = record.arg < std::size(kIRQNames) ? kIRQNames[record.arg] : "?";
+
+        stream << fmt::format(
+          "{{\"name\":\"IRQ: {}\",\"ph\":\"i\",\"s\":\"t\",\"pid\":0,\"tid\":{},\"ts\":{:.3f},\"args\":{{\"cycle\":{}}}}},\n",
+          name, (int)ThreadIRQ, us(record.host_time), record.timestamp);
+        break;
+      }
+      case Type::Halt: {
+        stream << fmt::format(
+          "{{\"name\":\"HALT\",\"ph\":\"X\",\"pid\":0,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f},\"args\":{{\"cycle\":{}}}}},\n",
+          (int)ThreadCPU, us(record.host_time), us(record.host_duration), record.timestamp);
+        break;
+      }
+      case Type::Frame: {
+        stream << fmt::format(
+          "{{\"name\":\"Frame\",\"ph\":\"i\",\"s\":\"g\",\"pid\":0,\"tid\":0,\"ts\":{:.3f},\"args\":{{\"cycle\":{}}}}},\n",
+          us(record.host_time), record.timestamp);
+        break;
+      }
+    }
+  }
+
+  // Chrome does not accept a trailing comma, so finish with a dummy metadata record.
+  stream << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"NanoBoyAdvance\"}}\n]}\n";
+}
+
+} // namespace nba
@@ -42,6 +42,22 @@ struct PlatformConfig : Config {
     bool lcd_ghosting = true;
   } video;
 
+  struct RunAhead {
+    int frames = 0;
+    bool secondary_core = false;
+  } run_ahead;
+
+  struct Timing {
+    // Spin for the last part of each frame, which trades CPU usage for more consistent frame pacing.
+    bool precise_frame_pacing = true;
+
+    // Pace the emulation by the audio output instead of the frame limiter.
+    bool sync_to_audio = false;
+
+    // Speed multiplier while fast-forwarding, zero means unbounded.
+    int fast_forward_speed = 0;
+  } timing;
+
   void Load(std::string const& path);
   void Save(std::string const& path);
 
@@ -8,13 +8,17 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <functional>
+#include <memory>
 #include <nba/core.hpp>
 #include <nba/integer.hpp>
+#include <nba/movie.hpp>
 #include <platform/frame_limiter.hpp>
+#include <platform/mpsc_queue.hpp>
+#include <platform/run_ahead.hpp>
 #include <thread>
-#include <queue>
-#include <mutex>
+#include <vector>
 
 namespace nba {
 
@@ -27,8 +31,29 @@ struct EmulatorThread {
   void SetPause(bool value);
   bool GetFastForward() const;
   void SetFastForward(bool enabled);
+
+  /**
+   * Speed multiplier while fast-forwarding, zero means unbounded.
+   * At a bounded speed every n-th frame is presented, when unbounded frames are presented at the normal frame rate.
+   * The PPU skips the composition of frames which are not presented.
+   */
+  auto GetFastForwardSpeed() const -> int;
+  void SetFastForwardSpeed(int speed);
+  auto GetFrameLimiterMode() const -> FrameLimiter::Mode;
+  void SetFrameLimiterMode(FrameLimiter::Mode mode);
+  auto GetFrameLimiterStatistics() -> FrameLimiter::Statistics;
+
+  /**
+   * Pace the emulation by the audio output instead of the frame limiter:
+   * each sub-frame waits until the audio device has drained the audio buffer to half full.
+   */
+  auto GetSyncToAudio() const -> bool;
+  void SetSyncToAudio(bool enabled);
   void SetFrameRateCallback(std::function<void(float)> callback);
   void SetPerFrameCallback(std::function<void()> callback);
+  auto GetRunAhead() const -> int;
+  void SetRunAhead(int frames);
+  void SetRunAheadCore(std::unique_ptr<CoreBase> core);
 
   void Start(std::unique_ptr<CoreBase> core);
   std::unique_ptr<CoreBase> Stop();
@@ -36,10 +61,46 @@ struct EmulatorThread {
   void Reset();
   void SetKeyStatus(Key key, bool pressed);
 
+  /**
+   * Copies the state of the core in between two sub-frames, without stopping the emulator thread.
+   * The callback is invoked on the emulator thread, so it should hand the state off to another thread.
+   */
+  void CopyState(std::function<void(std::unique_ptr<SaveState>)> callback);
+
+  void LoadState(std::unique_ptr<SaveState> save_state);
+
+  /**
+   * Starts recording from the current state of the core, or from a reset if from_save_state is false.
+   * Run-ahead is suspended while recording. Reset() and LoadState() end the recording,
+   * StopMovieRecording() then still returns the movie up to that point.
+   */
+  void StartMovieRecording(std::vector<u8> bios, bool from_save_state);
+
+  // The callback receives the recorded movie on the emulator thread.
+  void StopMovieRecording(std::function<void(InputMovie&)> callback);
+
+  /**
+   * Plays back the movie until it ends or StopMoviePlayback() is called. Key input is ignored during playback.
+   * The callback is invoked on the emulator thread, with the result of checking the ROM and BIOS against the movie.
+   */
+  void StartMoviePlayback(
+    std::shared_ptr<InputMovie const> movie,
+    std::vector<u8> bios,
+    std::function<void(MoviePlayer::Result)> callback = nullptr
+  );
+
+  void StopMoviePlayback();
+
 private:
   enum class MessageType : u8 {
     Reset,
-    SetKeyStatus
+    SetKeyStatus,
+    CopyState,
+    LoadState,
+    StartMovieRecording,
+    StopMovieRecording,
+    StartMoviePlayback,
+    StopMoviePlayback
   };
 
   struct Message {
@@ -49,12 +110,23 @@ private:
         Key key;
         u8bool pressed;
       } set_key_status;
+      struct {
+        u8bool from_save_state;
+      } start_movie_recording;
     };
+    std::unique_ptr<SaveState> save_state;
+    std::shared_ptr<InputMovie const> movie;
+    std::vector<u8> bios;
+    std::function<void(std::unique_ptr<SaveState>)> copy_state_cb;
+    std::function<void(InputMovie&)> movie_recorded_cb;
+    std::function<void(MoviePlayer::Result)> movie_playback_cb;
   };
 
-  void PushMessage(const Message& message);
+  void WaitForAudioBuffer();
+  bool PresentFastForwardFrame();
+  void PushMessage(Message&& message);
   void ProcessMessages();
-  void ProcessMessage(const Message& message);
+  void ProcessMessage(Message& message);
 
   static constexpr int k_number_of_input_subframes = 4;
   static constexpr int k_cycles_per_second = 16777216;
@@ -63,11 +135,28 @@ private:
 
   static_assert(k_cycles_per_frame % k_number_of_input_subframes == 0);
 
-  std::queue<Message> msg_queue;
-  std::mutex msg_queue_mutex;
+  static constexpr std::chrono::nanoseconds k_frame_duration{(s64)k_cycles_per_frame * 1000000000 / k_cycles_per_second};
+
+  static constexpr float k_audio_sync_target_fill = 0.5;
+
+  // Stop waiting for the audio device, if it has not pulled any samples for this long.
+  static constexpr std::chrono::milliseconds k_audio_sync_timeout{50};
+
+  static constexpr size_t k_message_queue_capacity = 64;
+
+  MPSCQueue<Message, k_message_queue_capacity> msg_queue;
 
   std::unique_ptr<CoreBase> core;
   FrameLimiter frame_limiter;
+  RunAhead run_ahead;
+  MovieRecorder movie_recorder;
+  MoviePlayer movie_player;
+  std::shared_ptr<InputMovie const> movie;
+  std::atomic_int run_ahead_frames = 0;
+  std::atomic_bool sync_to_audio = false;
+  int fast_forward_frame = 0;
+  bool present_next_frame = true;
+  std::chrono::steady_clock::time_point timestamp_last_present;
   std::thread thread;
   std::atomic_bool running = false;
   bool paused = false;
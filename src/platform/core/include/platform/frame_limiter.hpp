@@ -7,13 +7,30 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <functional>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 namespace nba {
 
 struct FrameLimiter {
+  enum class Mode {
+    // Sleep until the deadline, which is subject to the wakeup latency of the OS scheduler.
+    Sleep,
+    // Sleep until shortly before the deadline, then spin until the deadline.
+    Hybrid
+  };
+
+  // How late frames have been in the last second, in microseconds.
+  struct Statistics {
+    float mean = 0;
+    float p99 = 0;
+    float max = 0;
+  };
+
   FrameLimiter(float fps = 60.0) {
     Reset(fps);
   }
@@ -23,19 +40,46 @@ struct FrameLimiter {
   auto GetFastForward() const -> bool;
   void SetFastForward(bool value);
 
+  // Speed multiplier while fast-forwarding, zero means unbounded.
+  auto GetFastForwardSpeed() const -> int;
+  void SetFastForwardSpeed(int speed);
+  auto GetMode() const -> Mode;
+  void SetMode(Mode mode);
+
+  // Do not wait for the deadline, because the caller paces the frames by other means, for example the audio output.
+  void SetExternalPacing(bool value);
+  auto GetStatistics() -> Statistics;
+
   void Run(
     std::function<void(void)> frame_advance,
     std::function<void(float)> update_fps
   );
 
 private:
+  void WaitForDeadline();
+  void UpdateStatistics();
+
   static constexpr int kMillisecondsPerSecond = 1000;
   static constexpr int kMicrosecondsPerSecond = 1000000;
 
+  static constexpr int kDefaultSpinMargin = 1000;
+  static constexpr int kMinimumSpinMargin = 100;
+
   int frame_count = 0;
   int frame_duration;
   float frames_per_second;
   bool fast_forward = false;
+  bool external_pacing = false;
+  bool waited_last_frame = false;
+  std::atomic_int fast_forward_speed = 0;
+  std::atomic<Mode> mode = Mode::Sleep;
+
+  // Time in microseconds before the deadline at which the hybrid mode stops sleeping, adapted to the observed oversleep.
+  int spin_margin = kDefaultSpinMargin;
+
+  std::vector<float> lateness_samples;
+  Statistics statistics;
+  std::mutex statistics_mutex;
 
   std::chrono::time_point<std::chrono::steady_clock> timestamp_target;
   std::chrono::time_point<std::chrono::steady_clock> timestamp_fps_update;
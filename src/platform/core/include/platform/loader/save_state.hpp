@@ -29,7 +29,15 @@ struct SaveStateLoader {
     fs::path const& path
   ) -> Result;
 
+  // Reads and validates the save state, without loading it into a core.
+  static auto Load(
+    SaveState& save_state,
+    fs::path const& path
+  ) -> Result;
+
 private:
+  static auto LoadChunked(fs::path const& path, SaveState& save_state) -> Result;
+  static auto LoadLegacy(fs::path const& path, SaveState& save_state) -> Result;
   static auto Validate(SaveState const& save_state) -> Result;
 };
 
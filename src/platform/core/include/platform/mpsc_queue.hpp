@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2024 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace nba {
+
+/**
+ * Bounded lock-free queue for multiple producers and a single consumer.
+ * All elements are allocated up-front, pushing and popping only move values in and out of the ring buffer.
+ *
+ * Every cell has a sequence number, which tells whether it is free to be written (sequence == position)
+ * or holds a value which is ready to be read (sequence == position + 1).
+ * Producers claim a position by incrementing the enqueue position and publish the value by updating the sequence number.
+ */
+template<typename T, size_t capacity>
+struct MPSCQueue {
+  static_assert(capacity >= 2 && (capacity & (capacity - 1)) == 0, "MPSCQueue: capacity must be a power of two");
+
+  MPSCQueue() {
+    for(size_t i = 0; i < capacity; i++) {
+      cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  MPSCQueue(MPSCQueue const&) = delete;
+  auto operator=(MPSCQueue const&) -> MPSCQueue& = delete;
+
+  // Returns false if the queue is full. May be called from any thread.
+  bool TryPush(T&& value) {
+    size_t position = enqueue_position.load(std::memory_order_relaxed);
+
+    while(true) {
+      auto& cell = cells[position & (capacity - 1)];
+
+      const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+      const auto difference = (std::ptrdiff_t)(sequence - position);
+
+      if(difference == 0) {
+        if(enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          cell.value = std::move(value);
+          cell.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      } else if(difference < 0) {
+        // The cell still holds a value from the previous lap, which has not been read yet.
+        return false;
+      } else {
+        position = enqueue_position.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /**
+   * Returns false if the queue is empty. May only be called from the consumer thread.
+   * If the queue is empty this is a single atomic load, so it is cheap to poll.
+   */
+  bool TryPop(T& value) {
+    auto& cell = cells[dequeue_position & (capacity - 1)];
+
+    if(cell.sequence.load(std::memory_order_acquire) != dequeue_position + 1) {
+      return false;
+    }
+
+    value = std::move(cell.value);
+    cell.sequence.store(dequeue_position + capacity, std::memory_order_release);
+    dequeue_position++;
+    return true;
+  }
+
+private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  Cell cells[capacity];
+
+  // Keep producer and consumer positions on separate cache lines.
+  alignas(64) std::atomic<size_t> enqueue_position = 0;
+  alignas(64) size_t dequeue_position = 0;
+};
+
+} // namespace nba
@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2024 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <nba/core.hpp>
+#include <nba/snapshot.hpp>
+
+namespace nba {
+
+/**
+ * Run-ahead hides the input latency of a game by displaying the frame it would render a few frames into the future.
+ * After every frame a snapshot of the core is taken, the core runs ahead with audio output and all but the last frame suppressed,
+ * and then the snapshot is restored.
+ * With a secondary core the run-ahead is done on the secondary core, which is synchronized to the primary core every frame.
+ * The primary core then never has to be restored.
+ */
+struct RunAhead {
+  auto GetFrames() const -> int {
+    return frames;
+  }
+
+  void SetFrames(int frames);
+
+  auto GetSecondaryCore() -> CoreBase* {
+    return secondary_core.get();
+  }
+
+  void SetSecondaryCore(std::unique_ptr<CoreBase> core);
+
+  // The key status must be forwarded to the secondary core, since it is not part of the save state.
+  void SetKeyStatus(Key key, bool pressed);
+
+  // Must be called after each frame that the primary core has run.
+  void Run(CoreBase& core);
+
+private:
+  int frames = 0;
+  std::unique_ptr<CoreBase> secondary_core;
+  SnapshotHandle snapshot;
+};
+
+} // namespace nba
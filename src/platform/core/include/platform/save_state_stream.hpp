@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2024 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <fstream>
+#include <nba/integer.hpp>
+#include <nba/save_state.hpp>
+#include <ostream>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+
+namespace nba {
+
+/**
+ * Save state files start with a header (magic number and format version), which is followed by a sequence of chunks.
+ * Each chunk consists of a tag, the payload length, the CRC32 of the payload, the stored length and the payload itself.
+ * The payload of a chunk is one section of the SaveState structure. Chunks with an unknown tag are skipped.
+ * If the stored length differs from the payload length, the payload is run-length encoded.
+ *
+ * Fields may only ever be appended to the end of a section. A section from an older version then simply is shorter
+ * and is zero-extended on load, while a section from a newer version is truncated.
+ * The payload is a raw copy of the section, so this only holds for fields appended after its last member:
+ * growing a nested structure (for example ppu.io or apu.io) shifts the members that follow it and requires
+ * either a new chunk for the nested structure or a SaveState version bump with an explicit upgrade.
+ */
+struct SaveStateStream {
+  static constexpr u32 kMagicNumber = 0x4353424E; // NBSC
+  static constexpr u32 kFormatVersion = 2;
+
+  static constexpr auto MakeTag(char const (&name)[5]) -> u32 {
+    return (u32)name[0] | ((u32)name[1] << 8) | ((u32)name[2] << 16) | ((u32)name[3] << 24);
+  }
+};
+
+struct SaveStateStreamWriter {
+  // Writes the file header.
+  SaveStateStreamWriter(std::ostream& stream);
+
+  void WriteChunk(u32 tag, void const* data, size_t size);
+
+  // Writes every section of the save state as a chunk.
+  void WriteSaveState(SaveState const& save_state);
+
+  auto Good() const -> bool {
+    return stream.good();
+  }
+
+private:
+  std::ostream& stream;
+};
+
+/**
+ * Reads save state files lazily: Open() only reads the chunk headers,
+ * the payload of a chunk is read and verified once it is requested.
+ */
+struct SaveStateStreamReader {
+  enum class Result {
+    CannotOpenFile,
+    BadImage,
+    UnsupportedVersion,
+    Success
+  };
+
+  auto Open(fs::path const& path) -> Result;
+
+  auto HasChunk(u32 tag) const -> bool {
+    return chunks.find(tag) != chunks.end();
+  }
+
+  /**
+   * Reads up to `size` bytes of the payload into `data` and zero-fills the rest.
+   * If the chunk does not exist, all of `data` is zero-filled.
+   * Returns false if the payload cannot be read or its CRC32 does not match.
+   */
+  bool ReadChunk(u32 tag, void* data, size_t size);
+
+  // Reads every section of the save state.
+  bool ReadSaveState(SaveState& save_state);
+
+private:
+  struct Chunk {
+    std::streamoff offset;
+    u32 length;
+    u32 stored_length;
+    u32 crc32;
+  };
+
+  std::ifstream stream;
+  std::unordered_map<u32, Chunk> chunks;
+};
+
+} // namespace nba
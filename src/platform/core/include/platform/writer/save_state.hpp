@@ -7,9 +7,16 @@
 
 #pragma once
 
+#include <condition_variable>
 #include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
 #include <nba/core.hpp>
+#include <queue>
 #include <string>
+#include <thread>
 
 namespace fs = std::filesystem;
 
@@ -26,6 +33,61 @@ struct SaveStateWriter {
     std::unique_ptr<CoreBase>& core,
     fs::path const& path
   ) -> Result;
+
+  static auto Write(
+    SaveState const& save_state,
+    fs::path const& path
+  ) -> Result;
+};
+
+/**
+ * Compresses and writes save states on a worker thread,
+ * so that the thread which captured the state does not have to wait for the disk.
+ * Save states are written in the order in which they were submitted.
+ * Each file is written to a temporary file first, which then replaces the target, so that a failed write keeps the previous file.
+ */
+struct AsyncSaveStateWriter {
+  using Callback = std::function<void(SaveStateWriter::Result)>;
+
+  AsyncSaveStateWriter();
+ ~AsyncSaveStateWriter();
+
+  // The callback is invoked on the worker thread, once the save state has been written.
+  void Write(
+    std::unique_ptr<SaveState> save_state,
+    fs::path const& path,
+    Callback callback = nullptr
+  );
+
+  /**
+   * Queues a save state which has not been captured yet, for example because it is copied on the emulator thread.
+   * The job keeps its place in the queue, so Flush() also waits for the state to be captured and written.
+   * If the promise is broken, the callback receives CannotWrite.
+   */
+  void Write(
+    std::future<std::unique_ptr<SaveState>> save_state,
+    fs::path const& path,
+    Callback callback = nullptr
+  );
+
+  // Blocks until all submitted save states have been written.
+  void Flush();
+
+private:
+  struct Job {
+    std::future<std::unique_ptr<SaveState>> save_state;
+    fs::path path;
+    Callback callback;
+  };
+
+  void ThreadMain();
+
+  std::queue<Job> jobs;
+  bool busy = false;
+  bool running = true;
+  std::mutex mutex;
+  std::condition_variable condition_variable;
+  std::thread thread;
 };
 
 } // namespace nba
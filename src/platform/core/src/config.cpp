@@ -5,6 +5,7 @@
  * Refer to the included LICENSE file.
  */
 
+#include <algorithm>
 #include <nba/log.hpp>
 #include <filesystem>
 #include <fstream>
@@ -37,6 +38,7 @@ void PlatformConfig::Load(std::string const& path) {
       auto general = general_result.unwrap();
       this->bios_path = (char8_t*)toml::find_or<std::string>(general, "bios_path", "bios.bin").c_str();
       this->skip_bios = toml::find_or<toml::boolean>(general, "bios_skip", false);
+      this->bios_hle = toml::find_or<toml::boolean>(general, "bios_hle", false);
       this->save_folder = (char8_t*)toml::find_or<std::string>(general, "save_folder", "").c_str();
     }
   }
@@ -137,6 +139,30 @@ void PlatformConfig::Load(std::string const& path) {
       this->audio.mp2k_hle_enable = toml::find_or<toml::boolean>(audio, "mp2k_hle_enable", false);
       this->audio.mp2k_hle_cubic = toml::find_or<toml::boolean>(audio, "mp2k_hle_cubic", true);
       this->audio.mp2k_hle_force_reverb = toml::find_or<toml::boolean>(audio, "mp2k_hle_force_reverb", true);
+      this->audio.dynamic_rate_control = toml::find_or<toml::boolean>(audio, "dynamic_rate_control", false);
+    }
+  }
+
+  if(data.contains("run_ahead")) {
+    auto run_ahead_result = toml::expect<toml::value>(data.at("run_ahead"));
+
+    if(run_ahead_result.is_ok()) {
+      auto run_ahead = run_ahead_result.unwrap();
+
+      this->run_ahead.frames = std::clamp(toml::find_or<int>(run_ahead, "frames", 0), 0, 4);
+      this->run_ahead.secondary_core = toml::find_or<toml::boolean>(run_ahead, "secondary_core", false);
+    }
+  }
+
+  if(data.contains("timing")) {
+    auto timing_result = toml::expect<toml::value>(data.at("timing"));
+
+    if(timing_result.is_ok()) {
+      auto timing = timing_result.unwrap();
+
+      this->timing.precise_frame_pacing = toml::find_or<toml::boolean>(timing, "precise_frame_pacing", true);
+      this->timing.sync_to_audio = toml::find_or<toml::boolean>(timing, "sync_to_audio", false);
+      this->timing.fast_forward_speed = std::clamp(toml::find_or<int>(timing, "fast_forward_speed", 0), 0, 8);
     }
   }
 
@@ -158,6 +184,7 @@ void PlatformConfig::Save(std::string const& path) {
   // General
   data["general"]["bios_path"] = std::string{(char*)this->bios_path.u8string().c_str()};
   data["general"]["bios_skip"] = this->skip_bios;
+  data["general"]["bios_hle"] = this->bios_hle;
   data["general"]["save_folder"] = std::string{(char*)this->save_folder.u8string().c_str()};
 
   // Cartridge
@@ -212,6 +239,16 @@ void PlatformConfig::Save(std::string const& path) {
   data["audio"]["mp2k_hle_enable"] = this->audio.mp2k_hle_enable;
   data["audio"]["mp2k_hle_cubic"] = this->audio.mp2k_hle_cubic;
   data["audio"]["mp2k_hle_force_reverb"] = this->audio.mp2k_hle_force_reverb;
+  data["audio"]["dynamic_rate_control"] = this->audio.dynamic_rate_control;
+
+  // Run-ahead
+  data["run_ahead"]["frames"] = this->run_ahead.frames;
+  data["run_ahead"]["secondary_core"] = this->run_ahead.secondary_core;
+
+  // Timing
+  data["timing"]["precise_frame_pacing"] = this->timing.precise_frame_pacing;
+  data["timing"]["sync_to_audio"] = this->timing.sync_to_audio;
+  data["timing"]["fast_forward_speed"] = this->timing.fast_forward_speed;
 
   SaveCustomData(data);
 
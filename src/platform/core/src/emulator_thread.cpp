@@ -5,6 +5,7 @@
  * Refer to the included LICENSE file.
  */
 
+#include <algorithm>
 #include <nba/log.hpp>
 #include <platform/emulator_thread.hpp>
 
@@ -38,6 +39,34 @@ void EmulatorThread::SetFastForward(bool enabled) {
   frame_limiter.SetFastForward(enabled);
 }
 
+auto EmulatorThread::GetFastForwardSpeed() const -> int {
+  return frame_limiter.GetFastForwardSpeed();
+}
+
+void EmulatorThread::SetFastForwardSpeed(int speed) {
+  frame_limiter.SetFastForwardSpeed(speed);
+}
+
+auto EmulatorThread::GetFrameLimiterMode() const -> FrameLimiter::Mode {
+  return frame_limiter.GetMode();
+}
+
+void EmulatorThread::SetFrameLimiterMode(FrameLimiter::Mode mode) {
+  frame_limiter.SetMode(mode);
+}
+
+auto EmulatorThread::GetFrameLimiterStatistics() -> FrameLimiter::Statistics {
+  return frame_limiter.GetStatistics();
+}
+
+auto EmulatorThread::GetSyncToAudio() const -> bool {
+  return sync_to_audio;
+}
+
+void EmulatorThread::SetSyncToAudio(bool enabled) {
+  sync_to_audio = enabled;
+}
+
 void EmulatorThread::SetFrameRateCallback(std::function<void(float)> callback) {
   frame_rate_cb = callback;
 }
@@ -46,6 +75,20 @@ void EmulatorThread::SetPerFrameCallback(std::function<void()> callback) {
   per_frame_cb = callback;
 }
 
+auto EmulatorThread::GetRunAhead() const -> int {
+  return run_ahead_frames;
+}
+
+void EmulatorThread::SetRunAhead(int frames) {
+  run_ahead_frames = frames;
+}
+
+void EmulatorThread::SetRunAheadCore(std::unique_ptr<CoreBase> core) {
+  Assert(!running, "Cannot change the run-ahead core while the emulator thread is running");
+
+  run_ahead.SetSecondaryCore(std::move(core));
+}
+
 void EmulatorThread::Start(std::unique_ptr<CoreBase> core) {
   Assert(!running, "Started an emulator thread which was already running");
 
@@ -53,16 +96,67 @@ void EmulatorThread::Start(std::unique_ptr<CoreBase> core) {
   running = true;
 
   thread = std::thread{[this]() {
+    int subframe = 0;
+
     frame_limiter.Reset();
 
     while(running.load()) {
       ProcessMessages();
 
-      frame_limiter.Run([this]() {
+      const bool audio_paced = sync_to_audio && !paused && !frame_limiter.GetFastForward();
+
+      if(audio_paced) {
+        WaitForAudioBuffer();
+      }
+
+      frame_limiter.SetExternalPacing(audio_paced);
+      frame_limiter.Run([this, &subframe]() {
         if(!paused) {
           // @todo: decide what to do with the per_frame_cb().
           per_frame_cb();
-          this->core->Run(k_cycles_per_subframe);
+
+          if(movie) {
+            movie_player.Run(*this->core, k_cycles_per_subframe);
+
+            if(movie_player.IsFinished(*this->core)) {
+              movie.reset();
+            }
+          } else {
+            this->core->Run(k_cycles_per_subframe);
+          }
+
+          if(++subframe == k_number_of_input_subframes) {
+            auto& config = this->core->GetConfig();
+
+            /**
+             * Run-ahead only hides input latency, which does not matter during movie playback or fast-forward.
+             * While recording a movie only the authoritative frames may run, restoring the core after running ahead must not
+             * affect the recorded timeline.
+             */
+            if(frame_limiter.GetFastForward()) {
+              /**
+               * The frames of the PPU are not aligned to ours, so a presented frame already begins during the frame before.
+               * Decide one frame in advance and only skip the composition if neither of both frames is presented.
+               */
+              const bool present = present_next_frame;
+
+              present_next_frame = PresentFastForwardFrame();
+              this->core->SetVideoEnabled(present);
+              config.skip_frame_composition = !present && !present_next_frame;
+            } else {
+              present_next_frame = true;
+              fast_forward_frame = 0;
+              config.skip_frame_composition = false;
+
+              if(movie || movie_recorder.IsRecording()) {
+                this->core->SetVideoEnabled(true);
+              } else {
+                run_ahead.SetFrames(run_ahead_frames.load());
+                run_ahead.Run(*this->core);
+              }
+            }
+            subframe = 0;
+          }
         }
       }, [this](float fps) {
         float real_fps = fps / k_number_of_input_subframes;
@@ -75,6 +169,10 @@ void EmulatorThread::Start(std::unique_ptr<CoreBase> core) {
 
     // Make sure all messages are handled before exiting
     ProcessMessages();
+
+    // Run-ahead or fast-forward may have left the video output of the core disabled.
+    this->core->SetVideoEnabled(true);
+    this->core->GetConfig().skip_frame_composition = false;
   }};
 }
 
@@ -87,6 +185,36 @@ std::unique_ptr<CoreBase> EmulatorThread::Stop() {
   return std::move(core);
 }
 
+void EmulatorThread::WaitForAudioBuffer() {
+  const auto timeout = std::chrono::steady_clock::now() + k_audio_sync_timeout;
+
+  while(core->GetAudioBufferFill() > k_audio_sync_target_fill && std::chrono::steady_clock::now() < timeout) {
+    std::this_thread::sleep_for(std::chrono::microseconds(250));
+  }
+}
+
+bool EmulatorThread::PresentFastForwardFrame() {
+  const int speed = frame_limiter.GetFastForwardSpeed();
+
+  if(speed != 0) {
+    if(fast_forward_frame >= speed) {
+      fast_forward_frame = 0;
+    }
+    return fast_forward_frame++ == 0;
+  }
+
+  // The host cannot display frames faster than the normal frame rate anyway, so skip the frames in between.
+  const auto now = std::chrono::steady_clock::now();
+
+  if(now - timestamp_last_present >= k_frame_duration) {
+    // Keep to the schedule, unless we have fallen behind by more than a frame.
+    timestamp_last_present = std::max(timestamp_last_present + k_frame_duration, now - k_frame_duration);
+    return true;
+  }
+
+  return false;
+}
+
 void EmulatorThread::Reset() {
   PushMessage({.type = MessageType::Reset});
 }
@@ -98,7 +226,53 @@ void EmulatorThread::SetKeyStatus(Key key, bool pressed) {
   });
 }
 
-void EmulatorThread::PushMessage(const Message& message) {
+void EmulatorThread::CopyState(std::function<void(std::unique_ptr<SaveState>)> callback) {
+  PushMessage({
+    .type = MessageType::CopyState,
+    .copy_state_cb = std::move(callback)
+  });
+}
+
+void EmulatorThread::LoadState(std::unique_ptr<SaveState> save_state) {
+  PushMessage({
+    .type = MessageType::LoadState,
+    .save_state = std::move(save_state)
+  });
+}
+
+void EmulatorThread::StartMovieRecording(std::vector<u8> bios, bool from_save_state) {
+  PushMessage({
+    .type = MessageType::StartMovieRecording,
+    .start_movie_recording = {.from_save_state = (u8bool)from_save_state},
+    .bios = std::move(bios)
+  });
+}
+
+void EmulatorThread::StopMovieRecording(std::function<void(InputMovie&)> callback) {
+  PushMessage({
+    .type = MessageType::StopMovieRecording,
+    .movie_recorded_cb = std::move(callback)
+  });
+}
+
+void EmulatorThread::StartMoviePlayback(
+  std::shared_ptr<InputMovie const> movie,
+  std::vector<u8> bios,
+  std::function<void(MoviePlayer::Result)> callback
+) {
+  PushMessage({
+    .type = MessageType::StartMoviePlayback,
+    .movie = std::move(movie),
+    .bios = std::move(bios),
+    .movie_playback_cb = std::move(callback)
+  });
+}
+
+void EmulatorThread::StopMoviePlayback() {
+  PushMessage({.type = MessageType::StopMoviePlayback});
+}
+
+void EmulatorThread::PushMessage(Message&& message) {
   // @todo: think of the best way to transparently handle messages
   // sent while the emulator thread isn't running.
   if(!IsRunning()) {
@@ -111,30 +285,77 @@ void EmulatorThread::PushMessage(const Message& message) {
     // Process them right away instead to reduce latency.
     ProcessMessage(message);
   } else {
-    std::lock_guard lock_guard{msg_queue_mutex};
-    msg_queue.push(message); // @todo: maybe use emplace.
+    // The queue only is full if the emulator thread has stalled, so wait for it to catch up.
+    while(!msg_queue.TryPush(std::move(message))) {
+      std::this_thread::yield();
+    }
   }
 }
 
 void EmulatorThread::ProcessMessages() {
-  // potential optimization: use a separate std::atomic_int to track the number of messages in the queue
-  // use atomic_int to do early bail out without acquiring the mutex.
-  std::lock_guard lock_guard{msg_queue_mutex};
+  Message message;
 
-  while(!msg_queue.empty()) {
-    ProcessMessage(msg_queue.front());
-    msg_queue.pop();
+  while(msg_queue.TryPop(message)) {
+    ProcessMessage(message);
   }
 }
 
-void EmulatorThread::ProcessMessage(const Message& message) {
+void EmulatorThread::ProcessMessage(Message& message) {
   switch(message.type) {
     case MessageType::Reset: {
+      // The timestamps would go backwards, so the recording ends here.
+      movie_recorder.Stop(*core);
       core->Reset();
+      movie.reset();
       break;
     }
     case MessageType::SetKeyStatus: {
-      core->SetKeyStatus(message.set_key_status.key, message.set_key_status.pressed);
+      // During movie playback the keys are controlled by the movie.
+      if(!movie) {
+        movie_recorder.SetKeyStatus(*core, message.set_key_status.key, message.set_key_status.pressed);
+        run_ahead.SetKeyStatus(message.set_key_status.key, message.set_key_status.pressed);
+      }
+      break;
+    }
+    case MessageType::CopyState: {
+      auto save_state = std::unique_ptr<SaveState>{new SaveState};
+      core->CopyState(*save_state);
+      message.copy_state_cb(std::move(save_state));
+      break;
+    }
+    case MessageType::LoadState: {
+      movie_recorder.Stop(*core);
+      core->LoadState(*message.save_state);
+      message.save_state.reset();
+      movie.reset();
+      break;
+    }
+    case MessageType::StartMovieRecording: {
+      movie_recorder.Start(*core, message.bios, message.start_movie_recording.from_save_state);
+      break;
+    }
+    case MessageType::StopMovieRecording: {
+      auto& recorded_movie = movie_recorder.Stop(*core);
+
+      if(message.movie_recorded_cb) {
+        message.movie_recorded_cb(recorded_movie);
+      }
+      break;
+    }
+    case MessageType::StartMoviePlayback: {
+      auto result = movie_player.Start(*core, *message.movie, message.bios);
+
+      if(result == MoviePlayer::Result::Success) {
+        movie = std::move(message.movie);
+      }
+
+      if(message.movie_playback_cb) {
+        message.movie_playback_cb(result);
+      }
+      break;
+    }
+    case MessageType::StopMoviePlayback: {
+      movie.reset();
       break;
     }
     default: Assert(false, "unhandled message type: {}", (int)message.type);
@@ -5,6 +5,7 @@
  * Refer to the included LICENSE file.
  */
 
+#include <algorithm>
 #include <platform/frame_limiter.hpp>
 
 namespace nba {
@@ -20,6 +21,9 @@ void FrameLimiter::Reset(float fps) {
   fast_forward = false;
   timestamp_target = std::chrono::steady_clock::now();
   timestamp_fps_update = std::chrono::steady_clock::now();
+  spin_margin = kDefaultSpinMargin;
+  lateness_samples.clear();
+  lateness_samples.reserve((size_t)fps * 2);
 }
 
 auto FrameLimiter::GetFastForward() const -> bool {
@@ -35,14 +39,54 @@ void FrameLimiter::SetFastForward(bool value) {
   }
 }
 
+auto FrameLimiter::GetFastForwardSpeed() const -> int {
+  return fast_forward_speed;
+}
+
+void FrameLimiter::SetFastForwardSpeed(int speed) {
+  fast_forward_speed = speed;
+}
+
+void FrameLimiter::SetExternalPacing(bool value) {
+  external_pacing = value;
+}
+
+auto FrameLimiter::GetMode() const -> Mode {
+  return mode;
+}
+
+void FrameLimiter::SetMode(Mode mode) {
+  this->mode = mode;
+}
+
+auto FrameLimiter::GetStatistics() -> Statistics {
+  std::lock_guard lock_guard{statistics_mutex};
+  return statistics;
+}
+
 void FrameLimiter::Run(
   std::function<void(void)> frame_advance,
   std::function<void(float)> update_fps
 ) {
-  if(!fast_forward) {
-    timestamp_target += std::chrono::microseconds(frame_duration);
+  const int speed = fast_forward ? fast_forward_speed.load() : 1;
+  const bool wait = speed != 0 && !external_pacing;
+
+  if(wait) {
+    // Do not try to catch up on the time that was spent without waiting.
+    if(!waited_last_frame) {
+      timestamp_target = std::chrono::steady_clock::now();
+    }
+
+    timestamp_target += std::chrono::microseconds(frame_duration / speed);
+
+    // While fast-forwarding, running behind only means that the host is slower than the speed multiplier.
+    if(speed != 1) {
+      timestamp_target = std::max(timestamp_target, std::chrono::steady_clock::now());
+    }
   }
 
+  waited_last_frame = wait;
+
   frame_advance();
   frame_count++;
     
@@ -51,14 +95,67 @@ void FrameLimiter::Run(
     now - timestamp_fps_update).count();
 
   if(fps_update_delta >= kMillisecondsPerSecond) {
+    UpdateStatistics();
     update_fps(frame_count * float(kMillisecondsPerSecond) / fps_update_delta);
     frame_count = 0;
     timestamp_fps_update = std::chrono::steady_clock::now();
   }
 
-  if(!fast_forward) {
+  if(wait) {
+    WaitForDeadline();
+  }
+}
+
+void FrameLimiter::WaitForDeadline() {
+  using namespace std::chrono;
+
+  if(mode == Mode::Hybrid) {
+    const auto timestamp_wakeup = timestamp_target - microseconds(spin_margin);
+
+    if(steady_clock::now() < timestamp_wakeup) {
+      std::this_thread::sleep_until(timestamp_wakeup);
+
+      // Grow the margin right away when the OS overslept, but only shrink it slowly.
+      const int oversleep = (int)duration_cast<microseconds>(steady_clock::now() - timestamp_wakeup).count();
+      const int margin = std::clamp(oversleep * 2, kMinimumSpinMargin, frame_duration / 2);
+
+      if(margin > spin_margin) {
+        spin_margin = margin;
+      } else {
+        spin_margin -= (spin_margin - margin) / 64;
+      }
+    }
+
+    // Busy-wait instead of yielding: on a loaded host a yield may give away a whole time slice.
+    while(steady_clock::now() < timestamp_target) {
+    }
+  } else {
     std::this_thread::sleep_until(timestamp_target);
   }
+
+  lateness_samples.push_back(duration<float, std::micro>(steady_clock::now() - timestamp_target).count());
+}
+
+void FrameLimiter::UpdateStatistics() {
+  Statistics statistics{};
+
+  if(!lateness_samples.empty()) {
+    for(float lateness : lateness_samples) {
+      statistics.mean += lateness;
+      statistics.max = std::max(statistics.max, lateness);
+    }
+    statistics.mean /= lateness_samples.size();
+
+    const auto p99 = lateness_samples.begin() + lateness_samples.size() * 99 / 100;
+
+    std::nth_element(lateness_samples.begin(), p99, lateness_samples.end());
+    statistics.p99 = *p99;
+
+    lateness_samples.clear();
+  }
+
+  std::lock_guard lock_guard{statistics_mutex};
+  this->statistics = statistics;
 }
 
 } // namespace nba
@@ -8,12 +8,29 @@
 #include <filesystem>
 #include <fstream>
 #include <platform/loader/save_state.hpp>
+#include <platform/save_state_stream.hpp>
 
 namespace nba {
 
 auto SaveStateLoader::Load(
   std::unique_ptr<CoreBase>& core,
   fs::path const& path
+) -> Result {
+  SaveState save_state;
+
+  auto result = Load(save_state, path);
+
+  if(result != Result::Success) {
+    return result;
+  }
+
+  core->LoadState(save_state);
+  return Result::Success;
+}
+
+auto SaveStateLoader::Load(
+  SaveState& save_state,
+  fs::path const& path
 ) -> Result {
   if(!fs::exists(path)) {
     return Result::CannotFindFile;
@@ -23,13 +40,50 @@ auto SaveStateLoader::Load(
     return Result::CannotOpenFile;
   }
 
-  auto file_size = fs::file_size(path);
+  u32 magic = 0;
 
-  if(file_size != sizeof(SaveState)) {
+  std::ifstream{path.c_str(), std::ios::binary}.read((char*)&magic, sizeof(magic));
+
+  // Legacy save states begin with the magic number of the SaveState structure.
+  auto result = magic == SaveState::kMagicNumber ? LoadLegacy(path, save_state) : LoadChunked(path, save_state);
+
+  if(result != Result::Success) {
+    return result;
+  }
+
+  return Validate(save_state);
+}
+
+auto SaveStateLoader::LoadChunked(fs::path const& path, SaveState& save_state) -> Result {
+  SaveStateStreamReader reader;
+
+  switch(reader.Open(path)) {
+    case SaveStateStreamReader::Result::CannotOpenFile: return Result::CannotOpenFile;
+    case SaveStateStreamReader::Result::BadImage: return Result::BadImage;
+    case SaveStateStreamReader::Result::UnsupportedVersion: return Result::UnsupportedVersion;
+    case SaveStateStreamReader::Result::Success: break;
+  }
+
+  if(!reader.HasChunk(SaveStateStream::MakeTag("HEAD")) || !reader.ReadSaveState(save_state)) {
     return Result::BadImage;
   }
 
-  SaveState save_state;
+  if(save_state.magic != SaveState::kMagicNumber || save_state.version > SaveState::kCurrentVersion) {
+    return Result::UnsupportedVersion;
+  }
+
+  // Sections of older versions have been zero-extended to the current layout.
+  save_state.version = SaveState::kCurrentVersion;
+  return Result::Success;
+}
+
+auto SaveStateLoader::LoadLegacy(fs::path const& path, SaveState& save_state) -> Result {
+  // Before the chunked format, save states were a plain copy of the SaveState structure.
+  const auto file_size = fs::file_size(path);
+
+  if(file_size != sizeof(SaveState)) {
+    return Result::BadImage;
+  }
 
   std::ifstream file_stream{path.c_str(), std::ios::binary};
 
@@ -39,13 +93,9 @@ auto SaveStateLoader::Load(
 
   file_stream.read((char*)&save_state, sizeof(SaveState));
 
-  auto validate_result = Validate(save_state);
-
-  if(validate_result != Result::Success) {
-    return validate_result;
-  }
+  // The last legacy save states predate the HLE section, which only took up structure padding.
+  UpgradeSaveState(save_state);
 
-  core->LoadState(save_state);
   return Result::Success;
 }
 
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2024 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <platform/run_ahead.hpp>
+#include <utility>
+
+namespace nba {
+
+void RunAhead::SetFrames(int frames) {
+  this->frames = frames;
+}
+
+void RunAhead::SetSecondaryCore(std::unique_ptr<CoreBase> core) {
+  secondary_core = std::move(core);
+
+  if(secondary_core) {
+    secondary_core->SetAudioEnabled(false);
+  }
+}
+
+void RunAhead::SetKeyStatus(Key key, bool pressed) {
+  if(secondary_core) {
+    secondary_core->SetKeyStatus(key, pressed);
+  }
+}
+
+void RunAhead::Run(CoreBase& core) {
+  // The primary core only presents its frames if we do not run ahead.
+  core.SetVideoEnabled(frames == 0);
+
+  if(frames == 0) {
+    return;
+  }
+
+  auto& ahead_core = secondary_core ? *secondary_core : core;
+
+  if(secondary_core) {
+    // Keep our reference, so that the snapshot can be updated in place next frame.
+    if(snapshot) {
+      core.CopySnapshot(*snapshot);
+    } else {
+      snapshot = core.CreateSnapshot();
+    }
+    secondary_core->LoadSnapshot(snapshot);
+  } else {
+    snapshot = core.CreateSnapshot();
+    core.SetAudioEnabled(false);
+  }
+
+  for(int i = 0; i < frames; i++) {
+    ahead_core.SetVideoEnabled(i == frames - 1);
+    ahead_core.RunForOneFrame();
+  }
+
+  ahead_core.SetVideoEnabled(false);
+
+  if(!secondary_core) {
+    // Hand over our only reference, so that the core swaps the memories back instead of copying them.
+    core.LoadSnapshot(std::move(snapshot));
+    core.SetAudioEnabled(true);
+  }
+}
+
+} // namespace nba
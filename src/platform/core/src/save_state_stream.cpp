@@ -0,0 +1,274 @@
+/*
+ * Copyright (C) 2024 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <nba/common/crc32.hpp>
+#include <platform/save_state_stream.hpp>
+#include <vector>
+
+namespace nba {
+
+namespace {
+
+struct Section {
+  u32 tag;
+  u8* data;
+  size_t size;
+};
+
+#define SECTION(tag, member) Section{SaveStateStream::MakeTag(tag), (u8*)&save_state.member, sizeof(save_state.member)}
+
+auto GetSections(SaveState& save_state) -> std::array<Section, 19> {
+  return {{
+    {SaveStateStream::MakeTag("HEAD"), (u8*)&save_state, (size_t)((u8*)&save_state.arm - (u8*)&save_state)},
+    SECTION("ARM ", arm),
+    SECTION("WRAM", bus.memory.wram),
+    SECTION("IRAM", bus.memory.iram),
+    SECTION("PRAM", bus.memory.pram),
+    SECTION("OAM ", bus.memory.oam),
+    SECTION("VRAM", bus.memory.vram),
+    // The remainder of the bus section, which follows the memories.
+    {SaveStateStream::MakeTag("BUS "), (u8*)&save_state.bus.memory.latch, (size_t)((u8*)&save_state.irq - (u8*)&save_state.bus.memory.latch)},
+    SECTION("IRQ ", irq),
+    SECTION("PPU ", ppu),
+    SECTION("APU ", apu),
+    SECTION("TIMR", timer),
+    SECTION("DMA ", dma),
+    SECTION("ROML", rom_address_latch),
+    SECTION("BKUP", backup),
+    SECTION("GPIO", gpio),
+    SECTION("KEYC", keycnt),
+    SECTION("HLE ", hle),
+    SECTION("SCHD", scheduler)
+  }};
+}
+
+#undef SECTION
+
+/**
+ * Simple run-length encoding, which mostly targets the large zero-filled areas of the save state:
+ * A control byte N < 128 is followed by N + 1 literal bytes.
+ * A control byte N >= 128 is followed by a single byte, which is repeated N - 125 times.
+ */
+auto Compress(u8 const* data, size_t size) -> std::vector<u8> {
+  std::vector<u8> output;
+
+  output.reserve(size);
+
+  size_t literal_start = 0;
+
+  const auto flush_literals = [&](size_t end) {
+    while(literal_start != end) {
+      const size_t count = std::min<size_t>(end - literal_start, 128);
+
+      output.push_back((u8)(count - 1));
+      output.insert(output.end(), data + literal_start, data + literal_start + count);
+      literal_start += count;
+    }
+  };
+
+  size_t i = 0;
+
+  while(i < size) {
+    size_t run = 1;
+
+    while(i + run < size && run < 130 && data[i + run] == data[i]) {
+      run++;
+    }
+
+    if(run >= 3) {
+      flush_literals(i);
+      output.push_back((u8)(run + 125));
+      output.push_back(data[i]);
+      literal_start = i + run;
+    }
+
+    i += run;
+  }
+
+  flush_literals(size);
+  return output;
+}
+
+bool Decompress(u8 const* data, size_t size, u8* output, size_t output_size) {
+  size_t i = 0;
+  size_t j = 0;
+
+  while(i < size) {
+    const u8 control = data[i++];
+
+    if(control < 128) {
+      const size_t count = control + 1;
+
+      if(i + count > size || j + count > output_size) {
+        return false;
+      }
+
+      std::memcpy(&output[j], &data[i], count);
+      i += count;
+      j += count;
+    } else {
+      const size_t count = control - 125;
+
+      if(i == size || j + count > output_size) {
+        return false;
+      }
+
+      std::memset(&output[j], data[i++], count);
+      j += count;
+    }
+  }
+
+  return j == output_size;
+}
+
+} // namespace
+
+SaveStateStreamWriter::SaveStateStreamWriter(std::ostream& stream) : stream{stream} {
+  const u32 header[2] { SaveStateStream::kMagicNumber, SaveStateStream::kFormatVersion };
+
+  stream.write((char const*)header, sizeof(header));
+}
+
+void SaveStateStreamWriter::WriteChunk(u32 tag, void const* data, size_t size) {
+  const auto compressed = Compress((u8 const*)data, size);
+
+  // Store the payload uncompressed, if compression does not make it any smaller.
+  if(compressed.size() < size) {
+    const u32 header[4] { tag, (u32)size, crc32((u8 const*)data, size), (u32)compressed.size() };
+
+    stream.write((char const*)header, sizeof(header));
+    stream.write((char const*)compressed.data(), (std::streamsize)compressed.size());
+  } else {
+    const u32 header[4] { tag, (u32)size, crc32((u8 const*)data, size), (u32)size };
+
+    stream.write((char const*)header, sizeof(header));
+    stream.write((char const*)data, (std::streamsize)size);
+  }
+}
+
+void SaveStateStreamWriter::WriteSaveState(SaveState const& save_state) {
+  for(auto const& section : GetSections(const_cast<SaveState&>(save_state))) {
+    WriteChunk(section.tag, section.data, section.size);
+  }
+}
+
+auto SaveStateStreamReader::Open(fs::path const& path) -> Result {
+  std::error_code error_code;
+
+  const auto file_size = fs::file_size(path, error_code);
+
+  if(error_code) {
+    return Result::CannotOpenFile;
+  }
+
+  stream = std::ifstream{path.c_str(), std::ios::binary};
+  chunks.clear();
+
+  if(!stream.good()) {
+    return Result::CannotOpenFile;
+  }
+
+  u32 header[2];
+
+  if(!stream.read((char*)header, sizeof(header)) || header[0] != SaveStateStream::kMagicNumber) {
+    return Result::BadImage;
+  }
+
+  const u32 version = header[1];
+
+  if(version > SaveStateStream::kFormatVersion) {
+    return Result::UnsupportedVersion;
+  }
+
+  // Version 1 did not support compression and had no stored length in the chunk header.
+  const size_t chunk_header_size = version == 1 ? 3 * sizeof(u32) : 4 * sizeof(u32);
+
+  std::streamoff offset = sizeof(header);
+
+  while(offset != (std::streamoff)file_size) {
+    u32 chunk_header[4];
+
+    if(!stream.read((char*)chunk_header, chunk_header_size)) {
+      return Result::BadImage;
+    }
+
+    if(version == 1) {
+      chunk_header[3] = chunk_header[1];
+    }
+
+    offset += chunk_header_size;
+
+    if(offset + chunk_header[3] > (std::streamoff)file_size) {
+      return Result::BadImage;
+    }
+
+    chunks[chunk_header[0]] = {offset, chunk_header[1], chunk_header[3], chunk_header[2]};
+
+    offset += chunk_header[3];
+    stream.seekg(offset);
+  }
+
+  return Result::Success;
+}
+
+bool SaveStateStreamReader::ReadChunk(u32 tag, void* data, size_t size) {
+  const auto match = chunks.find(tag);
+
+  if(match == chunks.end()) {
+    std::memset(data, 0, size);
+    return true;
+  }
+
+  auto const& chunk = match->second;
+
+  std::vector<u8> payload(chunk.stored_length);
+
+  stream.clear();
+  stream.seekg(chunk.offset);
+
+  if(!stream.read((char*)payload.data(), chunk.stored_length)) {
+    return false;
+  }
+
+  if(chunk.stored_length != chunk.length) {
+    std::vector<u8> compressed = std::move(payload);
+
+    payload.resize(chunk.length);
+
+    if(!Decompress(compressed.data(), compressed.size(), payload.data(), payload.size())) {
+      return false;
+    }
+  }
+
+  if(crc32(payload.data(), payload.size()) != chunk.crc32) {
+    return false;
+  }
+
+  const size_t copy_size = std::min<size_t>(size, chunk.length);
+
+  std::memcpy(data, payload.data(), copy_size);
+  std::memset((u8*)data + copy_size, 0, size - copy_size);
+  return true;
+}
+
+bool SaveStateStreamReader::ReadSaveState(SaveState& save_state) {
+  // Clear the padding between the sections.
+  std::memset(&save_state, 0, sizeof(SaveState));
+
+  for(auto const& section : GetSections(save_state)) {
+    if(!ReadChunk(section.tag, section.data, section.size)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+} // namespace nba
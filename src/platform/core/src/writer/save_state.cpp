@@ -6,6 +6,7 @@
  */
 
 #include <fstream>
+#include <platform/save_state_stream.hpp>
 #include <platform/writer/save_state.hpp>
 
 namespace nba {
@@ -14,22 +15,138 @@ auto SaveStateWriter::Write(
   std::unique_ptr<CoreBase>& core,
   fs::path const& path
 ) -> Result {
-  std::ofstream file_stream{path.c_str(), std::ios::binary};
+  SaveState save_state;
+  core->CopyState(save_state);
+
+  return Write(save_state, path);
+}
+
+auto SaveStateWriter::Write(
+  SaveState const& save_state,
+  fs::path const& path
+) -> Result {
+  // Replace the file only once it has been written completely.
+  auto temporary_path = path;
+
+  temporary_path += ".tmp";
+
+  {
+    std::ofstream file_stream{temporary_path.c_str(), std::ios::binary};
+
+    if(!file_stream.good()) {
+      return Result::CannotOpenFile;
+    }
 
-  if(!file_stream.good()) {
-    return Result::CannotOpenFile;
+    SaveStateStreamWriter writer{file_stream};
+
+    writer.WriteSaveState(save_state);
+    file_stream.close();
+
+    if(!writer.Good() || file_stream.fail()) {
+      std::error_code error_code;
+      fs::remove(temporary_path, error_code);
+      return Result::CannotWrite;
+    }
   }
 
-  SaveState save_state;
-  core->CopyState(save_state);
+  std::error_code error_code;
+
+  fs::rename(temporary_path, path, error_code);
 
-  file_stream.write((const char*)&save_state, sizeof(SaveState));
-  
-  if(!file_stream.good()) {
+  if(error_code) {
+    fs::remove(temporary_path, error_code);
     return Result::CannotWrite;
   }
 
   return Result::Success;
 }
 
+AsyncSaveStateWriter::AsyncSaveStateWriter() {
+  thread = std::thread{[this]() {
+    ThreadMain();
+  }};
+}
+
+AsyncSaveStateWriter::~AsyncSaveStateWriter() {
+  {
+    std::lock_guard lock_guard{mutex};
+    running = false;
+  }
+
+  condition_variable.notify_all();
+  thread.join();
+}
+
+void AsyncSaveStateWriter::Write(
+  std::unique_ptr<SaveState> save_state,
+  fs::path const& path,
+  Callback callback
+) {
+  std::promise<std::unique_ptr<SaveState>> promise;
+
+  promise.set_value(std::move(save_state));
+  Write(promise.get_future(), path, std::move(callback));
+}
+
+void AsyncSaveStateWriter::Write(
+  std::future<std::unique_ptr<SaveState>> save_state,
+  fs::path const& path,
+  Callback callback
+) {
+  {
+    std::lock_guard lock_guard{mutex};
+    jobs.push({std::move(save_state), path, std::move(callback)});
+  }
+
+  condition_variable.notify_all();
+}
+
+void AsyncSaveStateWriter::Flush() {
+  std::unique_lock lock{mutex};
+
+  condition_variable.wait(lock, [this]() {
+    return jobs.empty() && !busy;
+  });
+}
+
+void AsyncSaveStateWriter::ThreadMain() {
+  std::unique_lock lock{mutex};
+
+  while(true) {
+    condition_variable.wait(lock, [this]() {
+      return !jobs.empty() || !running;
+    });
+
+    // Write all pending save states before exiting.
+    if(jobs.empty()) {
+      break;
+    }
+
+    auto job = std::move(jobs.front());
+    jobs.pop();
+    busy = true;
+    lock.unlock();
+
+    auto result = SaveStateWriter::Result::CannotWrite;
+
+    try {
+      const auto save_state = job.save_state.get();
+
+      if(save_state) {
+        result = SaveStateWriter::Write(*save_state, job.path);
+      }
+    } catch (std::future_error&) {
+      // The state was never captured, for example because the emulator thread has stopped.
+    }
+
+    if(job.callback) {
+      job.callback(result);
+    }
+
+    lock.lock();
+    busy = false;
+    condition_variable.notify_all();
+  }
+}
+
 } // namespace nba
\ No newline at end of file
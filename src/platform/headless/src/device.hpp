@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2024 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#pragma once
+
+#include <nba/device/audio_device.hpp>
+#include <nba/device/video_device.hpp>
+#include <nba/integer.hpp>
+#include <vector>
+
+namespace nba {
+
+// 64-bit FNV-1a
+inline auto HashBytes(void const* data, size_t size, u64 hash = 0xCBF29CE484222325ULL) -> u64 {
+  auto bytes = (u8 const*)data;
+
+  for(size_t i = 0; i < size; i++) {
+    hash = (hash ^ bytes[i]) * 0x100000001B3ULL;
+  }
+  return hash;
+}
+
+struct HashVideoDevice : VideoDevice {
+  void Draw(u32* buffer) final {
+    frame_hash = HashBytes(buffer, sizeof(u32) * 240 * 160);
+    video_hash = HashBytes(&frame_hash, sizeof(frame_hash), video_hash);
+    frame_count++;
+    last_frame.assign(buffer, buffer + 240 * 160);
+  }
+
+  u64 frame_hash = 0;
+  u64 video_hash = 0xCBF29CE484222325ULL;
+  int frame_count = 0;
+  std::vector<u32> last_frame;
+};
+
+/**
+ * Audio device that is not driven by a host audio API.
+ * Instead the frontend pulls a fixed number of samples per emulated frame, which keeps the output deterministic.
+ */
+struct HashAudioDevice : AudioDevice {
+  auto GetSampleRate() -> int final { return 32768; }
+  auto GetBlockSize() -> int final { return 1024; }
+
+  bool Open(void* userdata, Callback callback) final {
+    this->userdata = userdata;
+    this->callback = callback;
+    return true;
+  }
+
+  void SetPause(bool value) final { }
+
+  void Close() final {
+    callback = nullptr;
+  }
+
+  void Pull(int samples) {
+    if(callback == nullptr) {
+      return;
+    }
+
+    buffer.resize(samples * 2);
+    callback(userdata, buffer.data(), samples * 2 * sizeof(s16));
+    audio_hash = HashBytes(buffer.data(), buffer.size() * sizeof(s16), audio_hash);
+  }
+
+  u64 audio_hash = 0xCBF29CE484222325ULL;
+
+private:
+  void* userdata = nullptr;
+  Callback callback = nullptr;
+  std::vector<s16> buffer;
+};
+
+} // namespace nba
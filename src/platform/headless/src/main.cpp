@@ -0,0 +1,379 @@
+/*
+ * Copyright (C) 2024 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <fmt/format.h>
+#include <string>
+#include <vector>
+
+#include "regression.hpp"
+
+using namespace nba;
+
+static void usage(char const* argv0) {
+  fmt::print(
+    "usage: {} [options] <ROM or directory>...\n"
+    "\n"
+    "Runs every ROM for a fixed number of frames and compares the video and audio hashes against a manifest.\n"
+    "\n"
+    "options:\n"
+    "  --bios <path>       BIOS image (default: bios.bin)\n"
+    "  --frames <count>    number of frames to run per ROM (default: 600)\n"
+    "  --jobs <count>      number of ROMs to run in parallel (default: number of CPU cores)\n"
+    "  --manifest <path>   reference manifest (default: manifest.txt)\n"
+    "  --update            write the current results to the manifest instead of comparing\n"
+    "  --dump <directory>  write the last frame of each mismatching ROM as a PPM image\n"
+    "  --no-skip-bios      run the BIOS boot animation before the ROM\n"
+    "  --hle-bios          execute BIOS calls natively, the BIOS image becomes optional\n"
+    "  --run-ahead <count> run ahead the given number of frames after each frame\n"
+    "  --run-ahead-core    run ahead on a secondary core instead of restoring the primary core\n"
+    "  --skip-composition  compose only the last frames, the video hash then only covers the last frame\n"
+    "  --benchmark-run-ahead\n"
+    "                      measure the per-frame cost of run-ahead (1 to 4 frames, with and without a secondary core)\n"
+    "  --benchmark-audio-sync\n"
+    "                      simulate audio devices which run slightly fast or slow and report the audio buffer\n"
+    "                      under-runs and fill level with timer or audio pacing, with and without dynamic rate control\n"
+    "  --benchmark-composition\n"
+    "                      measure the per-frame cost with and without composition and check that the last frame\n"
+    "                      and the audio output are identical\n",
+    argv0
+  );
+}
+
+static bool parse_int(char const* string, int& value) {
+  const auto end = string + std::strlen(string);
+  const auto result = std::from_chars(string, end, value);
+
+  return result.ec == std::errc{} && result.ptr == end;
+}
+
+static bool is_rom(fs::path const& path) {
+  auto extension = path.extension().string();
+
+  std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)std::tolower(c); });
+
+  return extension == ".gba" || extension == ".zip" || extension == ".7z" || extension == ".rar";
+}
+
+static int benchmark_run_ahead(std::vector<fs::path> const& roms, RegressionTest::Options options) {
+  // Run the ROMs one after another, so that the timings are not disturbed by the other jobs.
+  options.jobs = 1;
+  options.dump_path.clear();
+
+  for(auto const& rom : roms) {
+    const auto run = [&](int run_ahead, bool run_ahead_core) -> RegressionTest::Result {
+      options.run_ahead = run_ahead;
+      options.run_ahead_core = run_ahead_core;
+      return RegressionTest::RunAll(rom.parent_path(), {rom}, options)[0];
+    };
+
+    const auto baseline = run(0, false);
+
+    if(!baseline.success) {
+      fmt::print("ERROR  {}: {}\n", baseline.name, baseline.error);
+      return 1;
+    }
+
+    const double baseline_ms = baseline.seconds * 1000.0 / options.frames;
+
+    fmt::print("{}\n", baseline.name);
+    fmt::print("  no run-ahead:          {:.3f} ms/frame\n", baseline_ms);
+
+    for(const bool run_ahead_core : {false, true}) {
+      for(int run_ahead = 1; run_ahead <= 4; run_ahead++) {
+        const auto result = run(run_ahead, run_ahead_core);
+
+        if(!result.success) {
+          fmt::print("ERROR  {}: {}\n", result.name, result.error);
+          return 1;
+        }
+
+        const double ms = result.seconds * 1000.0 / options.frames;
+
+        fmt::print("  {} {} frame(s): {:.3f} ms/frame (+{:.3f} ms, {:.2f}x)\n",
+          run_ahead_core ? "secondary core," : "restore,       ", run_ahead, ms, ms - baseline_ms, ms / baseline_ms);
+      }
+    }
+  }
+
+  return 0;
+}
+
+static int benchmark_audio_sync(std::vector<fs::path> const& roms, RegressionTest::Options options) {
+  static constexpr double kDrainRates[] { 0.995, 0.998, 1.0, 1.002, 1.005 };
+
+  options.jobs = 1;
+  options.dump_path.clear();
+
+  for(auto const& rom : roms) {
+    fmt::print("{}\n", rom.string());
+
+    for(const double drain_rate : kDrainRates) {
+      fmt::print("  drain rate {:.3f}:\n", drain_rate);
+
+      for(const bool sync_to_audio : {false, true}) {
+        for(const bool dynamic_rate_control : {false, true}) {
+          options.audio_drain_rate = drain_rate;
+          options.sync_to_audio = sync_to_audio;
+          options.dynamic_rate_control = dynamic_rate_control;
+
+          const auto result = RegressionTest::RunAll(rom.parent_path(), {rom}, options)[0];
+
+          if(!result.success) {
+            fmt::print("ERROR  {}: {}\n", result.name, result.error);
+            return 1;
+          }
+
+          auto const& audio = result.audio;
+
+          fmt::print("    {} {}: {:4} under-runs, {:4} overflows, fill {:.2f} (min {:.2f}, max {:.2f})\n",
+            sync_to_audio ? "audio," : "timer,", dynamic_rate_control ? "DRC   " : "no DRC",
+            audio.underruns, audio.overflows, audio.mean_fill, audio.min_fill, audio.max_fill);
+        }
+      }
+    }
+  }
+
+  return 0;
+}
+
+static int benchmark_composition(std::vector<fs::path> const& roms, RegressionTest::Options options) {
+  options.jobs = 1;
+  options.dump_path.clear();
+
+  int mismatches = 0;
+
+  for(auto const& rom : roms) {
+    const auto run = [&](bool skip_composition) -> RegressionTest::Result {
+      options.skip_composition = skip_composition;
+      return RegressionTest::RunAll(rom.parent_path(), {rom}, options)[0];
+    };
+
+    const auto composed = run(false);
+    const auto skipped = run(true);
+
+    for(auto const& result : {composed, skipped}) {
+      if(!result.success) {
+        fmt::print("ERROR  {}: {}\n", result.name, result.error);
+        return 1;
+      }
+    }
+
+    const double composed_ms = composed.seconds * 1000.0 / options.frames;
+    const double skipped_ms = skipped.seconds * 1000.0 / options.frames;
+    const bool match = composed.hashes.frame == skipped.hashes.frame && composed.hashes.audio == skipped.hashes.audio;
+
+    fmt::print("{} {}: {:.3f} ms/frame composed, {:.3f} ms/frame skipped ({:.2f}x)\n",
+      match ? "MATCH   " : "MISMATCH", rom.string(), composed_ms, skipped_ms, composed_ms / skipped_ms);
+
+    if(!match) {
+      mismatches++;
+    }
+  }
+
+  return mismatches == 0 ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+  RegressionTest::Options options{};
+  fs::path manifest_path = "manifest.txt";
+  bool update = false;
+  bool benchmark = false;
+  bool benchmark_audio = false;
+  bool benchmark_compose = false;
+  std::vector<fs::path> inputs;
+
+  options.bios_path = "bios.bin";
+
+  for(int i = 1; i < argc; i++) {
+    const auto argument = std::string{argv[i]};
+    const bool has_value = i + 1 < argc;
+
+    if(argument == "--bios" && has_value) {
+      options.bios_path = argv[++i];
+    } else if(argument == "--frames" && has_value) {
+      if(!parse_int(argv[++i], options.frames)) {
+        fmt::print("error: invalid value for {}: '{}'\n\n", argument, argv[i]);
+        usage(argv[0]);
+        return 2;
+      }
+    } else if(argument == "--jobs" && has_value) {
+      if(!parse_int(argv[++i], options.jobs)) {
+        fmt::print("error: invalid value for {}: '{}'\n\n", argument, argv[i]);
+        usage(argv[0]);
+        return 2;
+      }
+    } else if(argument == "--manifest" && has_value) {
+      manifest_path = argv[++i];
+    } else if(argument == "--dump" && has_value) {
+      options.dump_path = argv[++i];
+    } else if(argument == "--update") {
+      update = true;
+    } else if(argument == "--no-skip-bios") {
+      options.skip_bios = false;
+    } else if(argument == "--hle-bios") {
+      options.bios_hle = true;
+    } else if(argument == "--run-ahead" && has_value) {
+      if(!parse_int(argv[++i], options.run_ahead)) {
+        fmt::print("error: invalid value for {}: '{}'\n\n", argument, argv[i]);
+        usage(argv[0]);
+        return 2;
+      }
+      options.run_ahead = std::clamp(options.run_ahead, 0, 4);
+    } else if(argument == "--run-ahead-core") {
+      options.run_ahead_core = true;
+    } else if(argument == "--skip-composition") {
+      options.skip_composition = true;
+    } else if(argument == "--benchmark-run-ahead") {
+      benchmark = true;
+    } else if(argument == "--benchmark-audio-sync") {
+      benchmark_audio = true;
+    } else if(argument == "--benchmark-composition") {
+      benchmark_compose = true;
+    } else if(argument.compare(0, 2, "--") == 0) {
+      usage(argv[0]);
+      return 2;
+    } else {
+      inputs.emplace_back(argument);
+    }
+  }
+
+  if(inputs.empty()) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  // Collect ROMs. Names in the manifest are relative to the directory they were found in.
+  std::vector<fs::path> roms;
+  std::vector<fs::path> roots;
+
+  for(auto const& input : inputs) {
+    if(fs::is_directory(input)) {
+      std::vector<fs::path> found;
+
+      for(auto const& entry : fs::recursive_directory_iterator{input}) {
+        if(entry.is_regular_file() && is_rom(entry.path())) {
+          found.push_back(entry.path());
+        }
+      }
+
+      std::sort(found.begin(), found.end());
+
+      for(auto const& path : found) {
+        roms.push_back(path);
+        roots.push_back(input);
+      }
+    } else {
+      // A bare file name has no parent path, relative to which it would have an empty name.
+      roms.push_back(input);
+      roots.push_back(fs::absolute(input).parent_path());
+    }
+  }
+
+  if(benchmark) {
+    return benchmark_run_ahead(roms, options);
+  }
+
+  if(benchmark_audio) {
+    return benchmark_audio_sync(roms, options);
+  }
+
+  if(benchmark_compose) {
+    return benchmark_composition(roms, options);
+  }
+
+  std::vector<RegressionTest::Result> results;
+
+  // RunAll() names ROMs relative to a single root, so group ROMs by their root.
+  for(size_t i = 0; i < roms.size();) {
+    size_t j = i;
+
+    while(j < roms.size() && roots[j] == roots[i]) {
+      j++;
+    }
+
+    auto group = RegressionTest::RunAll(roots[i], {roms.begin() + i, roms.begin() + j}, options);
+
+    std::move(group.begin(), group.end(), std::back_inserter(results));
+    i = j;
+  }
+
+  RegressionTest::Manifest manifest;
+
+  if(!RegressionTest::LoadManifest(manifest_path, manifest) && !update) {
+    fmt::print("warning: cannot read manifest '{}', all ROMs will be reported as new\n", manifest_path.string());
+  }
+
+  int passed = 0;
+  int failed = 0;
+  int errors = 0;
+  double total_seconds = 0.0;
+
+  if(!options.dump_path.empty()) {
+    fs::create_directories(options.dump_path);
+  }
+
+  for(auto& result : results) {
+    if(!result.success) {
+      fmt::print("ERROR  {}: {}\n", result.name, result.error);
+      errors++;
+      continue;
+    }
+
+    const double fps = result.seconds > 0.0 ? result.hashes.frames / result.seconds : 0.0;
+
+    total_seconds += result.seconds;
+
+    if(update) {
+      manifest[result.name] = result.hashes;
+      fmt::print("UPDATE {} ({:.2f}s, {:.0f} fps)\n", result.name, result.seconds, fps);
+      continue;
+    }
+
+    const auto match = manifest.find(result.name);
+
+    if(match == manifest.end()) {
+      fmt::print("NEW    {} ({:.2f}s, {:.0f} fps)\n", result.name, result.seconds, fps);
+      failed++;
+    } else if(match->second == result.hashes) {
+      fmt::print("PASS   {} ({:.2f}s, {:.0f} fps)\n", result.name, result.seconds, fps);
+      passed++;
+    } else {
+      fmt::print("FAIL   {} ({:.2f}s, {:.0f} fps)\n", result.name, result.seconds, fps);
+      fmt::print("         expected: frame={:016x} video={:016x} audio={:016x} frames={}\n",
+        match->second.frame, match->second.video, match->second.audio, match->second.frames);
+      fmt::print("         actual:   frame={:016x} video={:016x} audio={:016x} frames={}\n",
+        result.hashes.frame, result.hashes.video, result.hashes.audio, result.hashes.frames);
+      failed++;
+    }
+
+    if(match == manifest.end() || !(match->second == result.hashes)) {
+      if(!options.dump_path.empty() && !result.last_frame.empty()) {
+        auto filename = result.name;
+
+        std::replace(filename.begin(), filename.end(), '/', '_');
+        RegressionTest::DumpFrame(options.dump_path / (filename + ".ppm"), result.last_frame);
+      }
+    }
+  }
+
+  if(update) {
+    if(!RegressionTest::SaveManifest(manifest_path, manifest)) {
+      fmt::print("error: cannot write manifest '{}'\n", manifest_path.string());
+      return 1;
+    }
+    fmt::print("\nupdated {} entries in '{}' ({:.2f}s total run time)\n", results.size() - errors, manifest_path.string(), total_seconds);
+    return errors == 0 ? 0 : 1;
+  }
+
+  fmt::print("\n{} passed, {} failed, {} errors ({:.2f}s total run time)\n", passed, failed, errors, total_seconds);
+
+  return (failed == 0 && errors == 0) ? 0 : 1;
+}
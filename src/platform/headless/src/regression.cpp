@@ -0,0 +1,297 @@
+/*
+ * Copyright (C) 2024 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fmt/format.h>
+#include <fstream>
+#include <nba/core.hpp>
+#include <platform/loader/bios.hpp>
+#include <platform/loader/rom.hpp>
+#include <platform/run_ahead.hpp>
+#include <sstream>
+#include <thread>
+
+#include "device.hpp"
+#include "regression.hpp"
+
+namespace nba {
+
+auto RegressionTest::RunAll(fs::path const& root, std::vector<fs::path> const& roms, Options const& options) -> std::vector<Result> {
+  std::vector<Result> results{roms.size()};
+  std::atomic<size_t> next_rom = 0;
+
+  int jobs = options.jobs;
+
+  if(jobs <= 0) {
+    jobs = std::max(1, (int)std::thread::hardware_concurrency());
+  }
+
+  const auto worker = [&]() {
+    while(true) {
+      const size_t i = next_rom.fetch_add(1);
+
+      if(i >= roms.size()) {
+        break;
+      }
+
+      results[i] = Run(roms[i], fs::relative(roms[i], root).generic_string(), options);
+    }
+  };
+
+  std::vector<std::thread> threads{};
+
+  for(int i = 0; i < std::min(jobs, (int)roms.size()); i++) {
+    threads.emplace_back(worker);
+  }
+
+  for(auto& thread : threads) {
+    thread.join();
+  }
+
+  return results;
+}
+
+auto RegressionTest::Run(fs::path const& rom_path, std::string const& name, Options const& options) -> Result {
+  // Emulated audio samples (at 32768 Hz) per frame, in 1/kCyclesPerFrame units to avoid drift.
+  static constexpr u64 kSampleRate = 32768;
+  static constexpr u64 kCyclesPerSecond = 16777216;
+
+  static std::atomic<int> next_save_id = 0;
+
+  Result result{};
+
+  result.name = name;
+
+  auto video_dev = std::make_shared<HashVideoDevice>();
+  auto audio_dev = std::make_shared<HashAudioDevice>();
+
+  std::vector<fs::path> save_paths;
+  std::vector<std::shared_ptr<Config>> configs;
+
+  const auto create_core = [&](std::shared_ptr<AudioDevice> audio_dev) -> std::unique_ptr<CoreBase> {
+    auto config = std::make_shared<Config>();
+
+    config->skip_bios = options.skip_bios;
+    config->bios_hle = options.bios_hle;
+    config->audio.dynamic_rate_control = options.dynamic_rate_control;
+
+    config->video_dev = video_dev;
+    config->audio_dev = audio_dev;
+    configs.push_back(config);
+
+    auto core = CreateCore(config);
+
+    const auto bios_result = BIOSLoader::Load(core, options.bios_path);
+
+    // Without a BIOS image the HLE falls back to its own minimal BIOS.
+    const bool bios_optional = options.bios_hle && bios_result == BIOSLoader::Result::CannotFindFile;
+
+    if(bios_result != BIOSLoader::Result::Success && !bios_optional) {
+      result.error = "cannot load BIOS";
+      return {};
+    }
+
+    // Use a fresh save file, so that the results do not depend on previous runs.
+    const auto save_path = fs::temp_directory_path() / fmt::format(
+      "nba-regression-{}-{}.sav", std::chrono::steady_clock::now().time_since_epoch().count(), next_save_id++);
+
+    save_paths.push_back(save_path);
+
+    if(ROMLoader::Load(core, rom_path, save_path) != ROMLoader::Result::Success) {
+      result.error = "cannot load ROM";
+      return {};
+    }
+
+    core->Reset();
+    return core;
+  };
+
+  const auto remove_save_files = [&]() {
+    for(auto const& save_path : save_paths) {
+      std::error_code error_code;
+      fs::remove(save_path, error_code);
+    }
+  };
+
+  auto core = create_core(audio_dev);
+
+  RunAhead run_ahead{};
+
+  run_ahead.SetFrames(options.run_ahead);
+
+  if(core && options.run_ahead_core) {
+    run_ahead.SetSecondaryCore(create_core(std::make_shared<NullAudioDevice>()));
+
+    if(!run_ahead.GetSecondaryCore()) {
+      core.reset();
+    }
+  }
+
+  if(!core) {
+    remove_save_files();
+    return result;
+  }
+
+  const auto time_begin = std::chrono::steady_clock::now();
+
+  const auto run_frame = [&](int frame) {
+    for(auto& config : configs) {
+      config->skip_frame_composition = options.skip_composition && frame < options.frames - 2;
+    }
+
+    core->RunForOneFrame();
+    run_ahead.Run(*core);
+  };
+
+  if(options.audio_drain_rate > 0.0) {
+    RunWithAudioClock(*core, run_frame, *audio_dev, options, result.audio);
+  } else {
+    u64 sample_accumulator = 0;
+
+    for(int frame = 0; frame < options.frames; frame++) {
+      run_frame(frame);
+
+      sample_accumulator += kSampleRate * CoreBase::kCyclesPerFrame;
+      audio_dev->Pull((int)(sample_accumulator / kCyclesPerSecond));
+      sample_accumulator %= kCyclesPerSecond;
+    }
+  }
+
+  const auto time_end = std::chrono::steady_clock::now();
+
+  core.reset();
+  run_ahead.SetSecondaryCore({});
+  remove_save_files();
+
+  result.success = true;
+  result.hashes = {video_dev->frame_hash, video_dev->video_hash, audio_dev->audio_hash, options.frames};
+  result.seconds = std::chrono::duration<double>(time_end - time_begin).count();
+  result.last_frame = std::move(video_dev->last_frame);
+  return result;
+}
+
+void RegressionTest::RunWithAudioClock(
+  CoreBase& core,
+  std::function<void(int)> const& run_frame,
+  HashAudioDevice& audio_dev,
+  Options const& options,
+  AudioStatistics& statistics
+) {
+  // The APU buffers four blocks of the audio device. Less than one block means the next pull will under-run.
+  static constexpr double kUnderrunFill = 0.25;
+  static constexpr double kTargetFill = 0.5;
+
+  const int block_size = audio_dev.GetBlockSize();
+  const double pull_interval = block_size / (audio_dev.GetSampleRate() * options.audio_drain_rate);
+  const double frame_interval = (double)CoreBase::kCyclesPerFrame / 16777216;
+
+  double next_pull = pull_interval;
+  double next_frame = 0.0;
+  double fill_sum = 0.0;
+
+  const auto pull = [&]() {
+    const double fill = core.GetAudioBufferFill();
+
+    if(fill < kUnderrunFill) {
+      statistics.underruns++;
+    }
+
+    statistics.pulls++;
+    statistics.min_fill = std::min(statistics.min_fill, fill);
+    statistics.max_fill = std::max(statistics.max_fill, fill);
+    fill_sum += fill;
+
+    audio_dev.Pull(block_size);
+    next_pull += pull_interval;
+  };
+
+  for(int frame = 0; frame < options.frames; frame++) {
+    if(options.sync_to_audio) {
+      // The host is assumed to emulate a frame in no time, so emulation only ever waits for the audio device.
+      while(core.GetAudioBufferFill() > kTargetFill) {
+        pull();
+      }
+    } else {
+      while(next_pull <= next_frame) {
+        pull();
+      }
+      next_frame += frame_interval;
+    }
+
+    run_frame(frame);
+
+    // A full buffer drops the samples that did not fit.
+    if(core.GetAudioBufferFill() >= 1.0) {
+      statistics.overflows++;
+    }
+  }
+
+  if(statistics.pulls != 0) {
+    statistics.mean_fill = fill_sum / statistics.pulls;
+  }
+}
+
+auto RegressionTest::LoadManifest(fs::path const& path, Manifest& manifest) -> bool {
+  std::ifstream file{path};
+
+  if(!file.good()) {
+    return false;
+  }
+
+  std::string line;
+
+  while(std::getline(file, line)) {
+    if(line.empty() || line[0] == '#') {
+      continue;
+    }
+
+    std::istringstream stream{line};
+    Hashes hashes;
+    std::string name;
+
+    stream >> std::hex >> hashes.frame >> hashes.video >> hashes.audio >> std::dec >> hashes.frames >> std::ws;
+    std::getline(stream, name);
+
+    if(stream.fail() || name.empty()) {
+      return false;
+    }
+
+    manifest[name] = hashes;
+  }
+
+  return true;
+}
+
+auto RegressionTest::SaveManifest(fs::path const& path, Manifest const& manifest) -> bool {
+  std::ofstream file{path};
+
+  if(!file.good()) {
+    return false;
+  }
+
+  file << "# frame hash, video hash, audio hash, frames, ROM\n";
+
+  for(auto const& [name, hashes] : manifest) {
+    file << fmt::format("{:016x} {:016x} {:016x} {} {}\n", hashes.frame, hashes.video, hashes.audio, hashes.frames, name);
+  }
+
+  return file.good();
+}
+
+void RegressionTest::DumpFrame(fs::path const& path, std::vector<u32> const& frame) {
+  std::ofstream file{path, std::ios::binary};
+
+  file << "P6\n240 160\n255\n";
+
+  for(u32 argb : frame) {
+    file.put((char)(argb >> 16)).put((char)(argb >> 8)).put((char)argb);
+  }
+}
+
+} // namespace nba
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2024 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <nba/integer.hpp>
+#include <string>
+#include <vector>
+
+namespace nba {
+
+namespace fs = std::filesystem;
+
+struct CoreBase;
+struct HashAudioDevice;
+
+struct RegressionTest {
+  struct Options {
+    fs::path bios_path;
+    fs::path dump_path;
+    int frames = 600;
+    int jobs = 0;
+    bool skip_bios = true;
+    bool bios_hle = false;
+    int run_ahead = 0;
+    bool run_ahead_core = false;
+
+    // Skip the composition of all frames but the last two, which are enough to present the last frame.
+    bool skip_composition = false;
+
+    // If non-zero, the audio device is drained in real-time (at the given multiple of its sample rate)
+    // on a simulated clock, instead of pulling the samples produced by each frame.
+    double audio_drain_rate = 0.0;
+    bool dynamic_rate_control = false;
+    bool sync_to_audio = false;
+  };
+
+  struct Hashes {
+    u64 frame;
+    u64 video;
+    u64 audio;
+    int frames;
+
+    bool operator==(Hashes const& other) const {
+      return frame == other.frame && video == other.video && audio == other.audio && frames == other.frames;
+    }
+  };
+
+  // Audio buffer statistics of a run with a simulated audio drain rate.
+  struct AudioStatistics {
+    int pulls = 0;
+    int underruns = 0;
+    int overflows = 0;
+    double mean_fill = 0.0;
+    double min_fill = 1.0;
+    double max_fill = 0.0;
+  };
+
+  struct Result {
+    std::string name;
+    bool success = false;
+    std::string error;
+    Hashes hashes{};
+    double seconds = 0.0;
+    std::vector<u32> last_frame;
+    AudioStatistics audio{};
+  };
+
+  using Manifest = std::map<std::string, Hashes>;
+
+  static auto RunAll(fs::path const& root, std::vector<fs::path> const& roms, Options const& options) -> std::vector<Result>;
+  static auto Run(fs::path const& rom_path, std::string const& name, Options const& options) -> Result;
+
+  static auto LoadManifest(fs::path const& path, Manifest& manifest) -> bool;
+  static auto SaveManifest(fs::path const& path, Manifest const& manifest) -> bool;
+
+  static void DumpFrame(fs::path const& path, std::vector<u32> const& frame);
+
+private:
+  static void RunWithAudioClock(
+    CoreBase& core,
+    std::function<void(int)> const& run_frame,
+    HashAudioDevice& audio_dev,
+    Options const& options,
+    AudioStatistics& statistics
+  );
+};
+
+} // namespace nba
@@ -59,6 +59,7 @@ MainWindow::MainWindow(
   core = nba::CreateCore(config);
   core_not_thread_safe = core.get();
   emu_thread = std::make_unique<nba::EmulatorThread>();
+  save_state_writer = std::make_unique<nba::AsyncSaveStateWriter>();
 
   app->installEventFilter(this);
 
@@ -78,6 +79,18 @@ MainWindow::MainWindow(
     }
   }, Qt::QueuedConnection);
 
+  connect(this, &MainWindow::SaveStateWritten, this, [this](int result) {
+    if((nba::SaveStateWriter::Result)result != nba::SaveStateWriter::Result::Success) {
+      QMessageBox box {this};
+      box.setIcon(QMessageBox::Critical);
+      box.setText(tr("Sorry, the save state could not be written to the disk. Make sure that you have sufficient disk space and permissions."));
+      box.setWindowTitle(tr("Failed to write to the disk"));
+      box.exec();
+    }
+
+    RenderSaveStateMenus();
+  }, Qt::QueuedConnection);
+
   UpdateWindowSize();
 }
 
@@ -87,6 +100,10 @@ MainWindow::~MainWindow() {
   (new QMainWindow{})->setCentralWidget(screen.get());
 
   emu_thread->Stop();
+  DestroyRunAheadCore();
+
+  // Finish writing any pending save states.
+  save_state_writer.reset();
 
   delete controller_manager;
 }
@@ -213,6 +230,9 @@ void MainWindow::CreateAudioMenu(QMenu* parent) {
   CreateBooleanOption(hq_menu, "Enable", &config->audio.mp2k_hle_enable, true);
   CreateBooleanOption(hq_menu, "Cubic interpolation", &config->audio.mp2k_hle_cubic, true);
   CreateBooleanOption(hq_menu, "Force reverb on", &config->audio.mp2k_hle_force_reverb, true);
+
+  menu->addSeparator();
+  CreateBooleanOption(menu, "Dynamic rate control", &config->audio.dynamic_rate_control);
 }
 
 void MainWindow::CreateInputMenu(QMenu* parent) {
@@ -236,6 +256,39 @@ void MainWindow::CreateSystemMenu(QMenu* parent) {
   });
 
   CreateBooleanOption(menu, "Skip BIOS", &config->skip_bios);
+  CreateBooleanOption(menu, "HLE BIOS calls", &config->bios_hle);
+
+  auto run_ahead_menu = menu->addMenu(tr("Run-ahead"));
+
+  CreateSelectionOption(run_ahead_menu, {
+    { "Off",      0 },
+    { "1 frame",  1 },
+    { "2 frames", 2 },
+    { "3 frames", 3 },
+    { "4 frames", 4 }
+  }, &config->run_ahead.frames, false, [this]() {
+    emu_thread->SetRunAhead(config->run_ahead.frames);
+  });
+
+  run_ahead_menu->addSeparator();
+  CreateBooleanOption(run_ahead_menu, "Use secondary core", &config->run_ahead.secondary_core, true);
+
+  CreateBooleanOption(menu, "Precise frame pacing", &config->timing.precise_frame_pacing, false, [this]() {
+    UpdateFrameLimiterMode();
+  });
+
+  CreateBooleanOption(menu, "Sync to audio", &config->timing.sync_to_audio, false, [this]() {
+    emu_thread->SetSyncToAudio(config->timing.sync_to_audio);
+  });
+
+  CreateSelectionOption(menu->addMenu(tr("Fast forward speed")), {
+    { "2x",        2 },
+    { "4x",        4 },
+    { "8x",        8 },
+    { "Unbounded", 0 }
+  }, &config->timing.fast_forward_speed, false, [this]() {
+    emu_thread->SetFastForwardSpeed(config->timing.fast_forward_speed);
+  });
 
   menu->addSeparator();
 
@@ -537,7 +590,6 @@ void MainWindow::RenderSaveStateMenus() {
 
       connect(action_save, &QAction::triggered, [=]() {
         SaveState(slot_filename);
-        RenderSaveStateMenus();
       });
     }
   }
@@ -769,6 +821,11 @@ void MainWindow::LoadROM(fs::path const& path) {
 
     switch(nba::BIOSLoader::Load(core, config->bios_path)) {
       case nba::BIOSLoader::Result::CannotFindFile: {
+        // The BIOS HLE brings its own minimal BIOS.
+        if(config->bios_hle) {
+          break;
+        }
+
         QMessageBox box {this};
         box.setText(tr("A Game Boy Advance BIOS file is required but cannot be located.\n\nWould you like to add one now?"));
         box.setIcon(QMessageBox::Question);
@@ -840,6 +897,17 @@ void MainWindow::LoadROM(fs::path const& path) {
   game_path = path.u16string();
   RenderSaveStateMenus();
 
+  emu_thread->SetRunAhead(config->run_ahead.frames);
+  emu_thread->SetSyncToAudio(config->timing.sync_to_audio);
+  emu_thread->SetFastForwardSpeed(config->timing.fast_forward_speed);
+  UpdateFrameLimiterMode();
+
+  DestroyRunAheadCore();
+
+  if(config->run_ahead.secondary_core) {
+    emu_thread->SetRunAheadCore(CreateRunAheadCore(path, save_path, save_type, force_gpio));
+  }
+
   // Reset the core and start the emulation thread.
   // If the emulator is currently paused force-clear the screen.
   core->Reset();
@@ -850,10 +918,11 @@ void MainWindow::LoadROM(fs::path const& path) {
 }
 
 auto MainWindow::LoadState(std::u16string const& path) -> nba::SaveStateLoader::Result {
-  bool was_running = emu_thread->IsRunning();
-  core = emu_thread->Stop();
+  // The save state may still be in the process of being written.
+  save_state_writer->Flush();
 
-  auto result = nba::SaveStateLoader::Load(core, path);
+  auto save_state = std::unique_ptr<nba::SaveState>{new nba::SaveState};
+  auto result = nba::SaveStateLoader::Load(*save_state, path);
 
   QMessageBox box {this};
   box.setIcon(QMessageBox::Critical);
@@ -879,36 +948,38 @@ auto MainWindow::LoadState(std::u16string const& path) -> nba::SaveStateLoader::
       break;
     }
     case nba::SaveStateLoader::Result::Success: {
+      if(emu_thread->IsRunning()) {
+        emu_thread->LoadState(std::move(save_state));
+      } else if(core) {
+        core->LoadState(*save_state);
+      }
       break;
     }
   }
 
-  if(was_running) {
-    emu_thread->Start(std::move(core));
-  }
-
   return result;
 }
 
-auto MainWindow::SaveState(std::u16string const& path) -> nba::SaveStateWriter::Result {
-  bool was_running = emu_thread->IsRunning();
-  core = emu_thread->Stop();
+void MainWindow::SaveState(std::u16string const& path) {
+  // Only the state is copied here, compression and disk I/O happen on the save state writer thread.
+  const auto on_written = [this](nba::SaveStateWriter::Result result) {
+    emit SaveStateWritten((int)result);
+  };
 
-  auto result = nba::SaveStateWriter::Write(core, path);
+  if(emu_thread->IsRunning()) {
+    // Queue the job right away, so that loading the save state afterwards waits for it to be written.
+    auto promise = std::make_shared<std::promise<std::unique_ptr<nba::SaveState>>>();
 
-  if(result != nba::SaveStateWriter::Result::Success) {
-    QMessageBox box {this};
-    box.setIcon(QMessageBox::Critical);
-    box.setText(tr("Sorry, the save state could not be written to the disk. Make sure that you have sufficient disk space and permissions."));
-    box.setWindowTitle(tr("Failed to write to the disk"));
-    box.exec();
-  }
+    save_state_writer->Write(promise->get_future(), path, on_written);
 
-  if(was_running) {
-    emu_thread->Start(std::move(core));
+    emu_thread->CopyState([promise](std::unique_ptr<nba::SaveState> save_state) {
+      promise->set_value(std::move(save_state));
+    });
+  } else if(core) {
+    auto save_state = std::unique_ptr<nba::SaveState>{new nba::SaveState};
+    core->CopyState(*save_state);
+    save_state_writer->Write(std::move(save_state), path, on_written);
   }
-
-  return result;
 }
 
 auto MainWindow::GetSavePath(fs::path const& rom_path, fs::path const& extension) -> fs::path {
@@ -925,6 +996,56 @@ auto MainWindow::GetSavePath(fs::path const& rom_path, fs::path const& extension
   return fs::path{rom_path}.replace_extension(extension);
 }
 
+auto MainWindow::CreateRunAheadCore(
+  fs::path const& rom_path,
+  fs::path const& save_path,
+  nba::Config::BackupType save_type,
+  nba::GPIODeviceType force_gpio
+) -> std::unique_ptr<nba::CoreBase> {
+  // The secondary core presents its frames on our screen, but must not take over the audio device.
+  auto run_ahead_config = std::make_shared<nba::Config>(*config);
+
+  run_ahead_config->audio_dev = std::make_shared<nba::NullAudioDevice>();
+
+  auto run_ahead_core = nba::CreateCore(run_ahead_config);
+
+  // Loading the BIOS already succeeded for the primary core.
+  nba::BIOSLoader::Load(run_ahead_core, config->bios_path);
+
+  /* The backup of the secondary core is overwritten from the primary core every frame.
+   * Give it a copy of the save file, so that the backup size matches and nothing is written back to the real save file.
+   * The copy is named after our process, so that multiple instances of the emulator do not share it.
+   */
+  run_ahead_save_path = fs::temp_directory_path() / QString{"nba-run-ahead-%1.sav"}.arg(QCoreApplication::applicationPid()).toStdU16String();
+
+  std::error_code error_code;
+
+  if(fs::exists(save_path)) {
+    fs::copy_file(save_path, run_ahead_save_path, fs::copy_options::overwrite_existing, error_code);
+  } else {
+    fs::remove(run_ahead_save_path, error_code);
+  }
+
+  if(nba::ROMLoader::Load(run_ahead_core, rom_path, run_ahead_save_path, save_type, force_gpio) != nba::ROMLoader::Result::Success) {
+    return {};
+  }
+
+  run_ahead_core->Reset();
+  return run_ahead_core;
+}
+
+void MainWindow::DestroyRunAheadCore() {
+  // The secondary core must release its save file before it can be deleted.
+  emu_thread->SetRunAheadCore({});
+
+  if(!run_ahead_save_path.empty()) {
+    std::error_code error_code;
+
+    fs::remove(run_ahead_save_path, error_code);
+    run_ahead_save_path.clear();
+  }
+}
+
 void MainWindow::SetKeyStatus(int channel, nba::Key key, bool pressed) {
   key_input[channel][(int)key] = pressed;
 
@@ -972,6 +1093,14 @@ void MainWindow::SetFullscreen(bool value) {
   }
 }
 
+void MainWindow::UpdateFrameLimiterMode() {
+  if(config->timing.precise_frame_pacing) {
+    emu_thread->SetFrameLimiterMode(nba::FrameLimiter::Mode::Hybrid);
+  } else {
+    emu_thread->SetFrameLimiterMode(nba::FrameLimiter::Mode::Sleep);
+  }
+}
+
 void MainWindow::UpdateSolarSensorLevel() {
   auto level = config->cartridge.solar_sensor_level;
 
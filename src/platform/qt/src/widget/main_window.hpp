@@ -44,6 +44,7 @@ struct MainWindow : QMainWindow {
 
 signals:
   void UpdateFrameRate(int fps);
+  void SaveStateWritten(int result);
 
 private slots:
   void FileOpen();
@@ -126,17 +127,26 @@ private:
   void UpdateWindowSize();
   void SetFullscreen(bool value);
 
+  void UpdateFrameLimiterMode();
   void UpdateSolarSensorLevel();
 
   auto LoadState(std::u16string const& path) -> nba::SaveStateLoader::Result;
-  auto SaveState(std::u16string const& path) -> nba::SaveStateWriter::Result;
+  void SaveState(std::u16string const& path);
 
   auto GetSavePath(fs::path const& rom_path, fs::path const& extension) -> fs::path;
+  auto CreateRunAheadCore(
+    fs::path const& rom_path,
+    fs::path const& save_path,
+    nba::Config::BackupType save_type,
+    nba::GPIODeviceType force_gpio
+  ) -> std::unique_ptr<nba::CoreBase>;
+  void DestroyRunAheadCore();
 
   std::shared_ptr<Screen> screen;
   std::shared_ptr<QtConfig> config = std::make_shared<QtConfig>();
   std::unique_ptr<nba::CoreBase> core;
   std::unique_ptr<nba::EmulatorThread> emu_thread;
+  std::unique_ptr<nba::AsyncSaveStateWriter> save_state_writer;
   bool key_input[2][(int)nba::Key::Count] {false};
   bool fast_forward[2] {false};
   ControllerManager* controller_manager;
@@ -154,6 +164,7 @@ private:
   QAction* fullscreen_action;
   bool game_loaded = false;
   std::u16string game_path;
+  fs::path run_ahead_save_path;
 
   nba::SaveState save_state_test;
 